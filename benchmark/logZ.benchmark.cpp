@@ -1,5 +1,6 @@
 #include "Backend.h"
 #include "Logger.h"
+#include "AllocCounter.h"  // Interposes malloc only in logZ.benchmark.check_alloc (LOGZ_ALLOC_COUNTER_INTERPOSE)
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -8,11 +9,17 @@
 #include <fstream>
 #include <iomanip>
 #include <ctime>
+#include <cstring>
 #include <sys/stat.h>
 #include <x86intrin.h>
 
 using namespace logZ;
 
+// --check-alloc: count producer allocations after each thread's first log
+// (queue growth is reported apart; needs the logZ.benchmark.check_alloc build)
+static bool check_alloc = false;
+static std::vector<AllocReport> alloc_reports;
+
 inline uint64_t rdtsc() {
     return __rdtsc();
 }
@@ -22,6 +29,9 @@ void worker_thread(int thread_id, int num_logs, std::vector<int>& latency, std::
     auto thread_start = std::chrono::steady_clock::now();
     // 写日志
     for (int i = 0; i < num_logs; ++i) {
+        if (check_alloc && i == 1) {
+            AllocCounter::arm();  // 第一条日志之后（队列已创建）
+        }
         s[3] = 'a' + (i % 26);
         auto start = rdtsc();
         LOG_INFO("Thread {} writing log {} with pi = {} and string {}", thread_id, i, 3.1415 +i, s);
@@ -32,19 +42,37 @@ void worker_thread(int thread_id, int num_logs, std::vector<int>& latency, std::
             std::this_thread::sleep_for(std::chrono::microseconds(1));
         }
     }
+    if (check_alloc) {
+        alloc_reports[thread_id] = AllocCounter::disarm();
+    }
     std::cout << "Thread " << thread_id << " completed " << num_logs << " logs." << std::endl;
     auto thread_end = std::chrono::steady_clock::now();
     std::chrono::duration<double> elapsed = thread_end - thread_start;
     thread_durations[thread_id] = elapsed.count();
 }
 
-int main() {
+int main(int argc, char** argv) {
     // 创建多个线程
     constexpr int num_threads = 8;
     constexpr int logs_per_thread = 1000000;
+    size_t format_workers = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--check-alloc") == 0) {
+            check_alloc = true;
+        } else if (std::strncmp(argv[i], "--format-workers=", 17) == 0) {
+            format_workers = std::strtoul(argv[i] + 17, nullptr, 10);  // 后台并行格式化线程数
+        }
+    }
+    if (check_alloc && !AllocCounter::installed()) {
+        std::cerr << "--check-alloc needs a build with LOGZ_ALLOC_COUNTER_INTERPOSE "
+                     "(bazel run //benchmark:logZ.benchmark.check_alloc -- --check-alloc)" << std::endl;
+        return 2;
+    }
+    alloc_reports.resize(num_threads);
     auto& backend = Logger::get_backend();  // Use Logger's get_backend()
     
-    std::cout << "Starting backend..." << std::endl;
+    std::cout << "Starting backend (format workers: " << format_workers << ")..." << std::endl;
+    backend.set_format_workers(format_workers);
     backend.start();
     
     // 让backend启动完成
@@ -69,6 +97,15 @@ int main() {
     }
     std::cout << "All threads joined." << std::endl;
 
+    int alloc_failures = 0;
+    if (check_alloc) {
+        std::cout << "\n=== Producer Allocations (after first log) ===" << std::endl;
+        for (int i = 0; i < num_threads; ++i) {
+            std::cout << "Thread " << i << ": " << alloc_reports[i].to_string() << std::endl;
+            alloc_failures += alloc_reports[i].allocations != 0;  // Queue growth is not a failure
+        }
+    }
+
     std::cout << "\n=== Thread Durations & QPS ===" << std::endl;
     double total_qps = 0.0;
     int total_logs = num_threads * logs_per_thread;
@@ -172,6 +209,10 @@ int main() {
     std::cout << "Stopping backend..." << std::endl;
     backend.stop();
     
+    if (alloc_failures != 0) {
+        std::cout << alloc_failures << " threads allocated on the hot path" << std::endl;
+        return 1;
+    }
     std::cout << "Program finished successfully!" << std::endl;    
     return 0;
 }
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "Queue.h"
+#include "StackTrace.h"
+
+// Allocation-free hot path verification (tests and benchmarks)
+//
+// Exactly one translation unit of the executable interposes the malloc
+// family by defining LOGZ_ALLOC_COUNTER_INTERPOSE before including this
+// header. Allocations are then counted per thread between
+// AllocCounter::arm() and AllocCounter::disarm():
+//
+//   log_once();                       // Warm-up: queue, call site, TLS
+//   AllocCounter::arm();
+//   for (...) log_once();             // Measured region
+//   AllocReport report = AllocCounter::disarm();
+//   if (report.allocations != 0) std::cerr << report.to_string();
+//
+// Known allocating paths of the producer: the first LOG_xxx call on a thread
+// (queue + registration), queue growth (Queue::reserve_write_slow) and
+// exceptions. Queue growth depends on how far the backend lags, so it is
+// counted apart (AllocReport::queue_growth_allocations), not as a hot-path
+// allocation.
+
+// Allocation sites captured per arm() (the rest are only counted)
+#ifndef LOGZ_ALLOC_COUNTER_SITES
+#define LOGZ_ALLOC_COUNTER_SITES 8
+#endif
+
+namespace logZ {
+
+/**
+ * @brief One allocation made while armed
+ */
+struct AllocSite {
+    size_t size;
+    StackTrace trace;  // Frame 0 is the caller of malloc (often operator new)
+};
+
+/**
+ * @brief Result of AllocCounter::disarm()
+ */
+struct AllocReport {
+    uint64_t allocations = 0;     // malloc / calloc / realloc / aligned calls
+    uint64_t bytes = 0;           // Bytes requested by those calls
+    uint64_t frees = 0;
+    uint64_t queue_growth_allocations = 0;  // Made by Queue::reserve_write_slow (not in allocations)
+    std::vector<AllocSite> sites; // First LOGZ_ALLOC_COUNTER_SITES allocations
+
+    /**
+     * @brief "N allocations (B bytes)" followed by a symbolized stack per site
+     */
+    std::string to_string() const {
+        std::string text = std::to_string(allocations) + " allocations (" + std::to_string(bytes) + " bytes)";
+        if (queue_growth_allocations != 0) {
+            text += ", " + std::to_string(queue_growth_allocations) + " for queue growth";
+        }
+        for (const auto& site : sites) {
+            text += "\n  " + std::to_string(site.size) + " bytes at:";
+            text += Symbolizer::instance().format(site.trace.frames, site.trace.depth);
+        }
+        return text;
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief Per-thread counter state
+ *
+ * Constant-initialized and trivially destructible, so touching it from
+ * malloc never allocates or runs a TLS constructor.
+ */
+struct AllocCounterState {
+    bool armed;
+    bool in_hook;      // Allocations made while capturing a stack are not counted
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t frees;
+    uint64_t queue_growth_allocations;
+    uint32_t site_count;
+    AllocSite sites[LOGZ_ALLOC_COUNTER_SITES];
+};
+
+inline constinit thread_local AllocCounterState alloc_counter_state{};
+
+/**
+ * @brief Called by the interposed allocation functions
+ */
+__attribute__((noinline))
+inline void on_alloc(size_t size) {
+    AllocCounterState& state = alloc_counter_state;
+    if (!state.armed || state.in_hook) {
+        return;
+    }
+    if (queue_growth_depth != 0) {
+        ++state.queue_growth_allocations;
+        return;
+    }
+    state.in_hook = true;
+    ++state.allocations;
+    state.bytes += size;
+    if (state.site_count < LOGZ_ALLOC_COUNTER_SITES) {
+        AllocSite& site = state.sites[state.site_count++];
+        site.size = size;
+        site.trace.depth = 0;
+        UnwindState unwind{&site.trace, 2};  // Skip on_alloc() and the malloc function
+        _Unwind_Backtrace(&unwind_callback, &unwind);
+    }
+    state.in_hook = false;
+}
+
+inline void on_free(void* ptr) {
+    AllocCounterState& state = alloc_counter_state;
+    if (ptr != nullptr && state.armed) {
+        ++state.frees;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Per-thread allocation counting (see the top of AllocCounter.h)
+ */
+class AllocCounter {
+public:
+    /**
+     * @brief Start counting allocations made by the calling thread
+     */
+    static void arm() {
+        detail::AllocCounterState& state = detail::alloc_counter_state;
+        state.allocations = 0;
+        state.bytes = 0;
+        state.frees = 0;
+        state.queue_growth_allocations = 0;
+        state.site_count = 0;
+        state.armed = true;
+    }
+
+    /**
+     * @brief Stop counting on the calling thread
+     * @return What was allocated since arm()
+     */
+    static AllocReport disarm() {
+        detail::AllocCounterState& state = detail::alloc_counter_state;
+        state.armed = false;
+        AllocReport report;
+        report.allocations = state.allocations;
+        report.bytes = state.bytes;
+        report.frees = state.frees;
+        report.queue_growth_allocations = state.queue_growth_allocations;
+        report.sites.assign(state.sites, state.sites + state.site_count);
+        return report;
+    }
+
+    /**
+     * @brief Whether the executable interposes malloc (LOGZ_ALLOC_COUNTER_INTERPOSE)
+     * Without it every report is empty.
+     */
+    static bool installed() {
+        void* (*volatile allocate)(size_t) = &std::malloc;  // Not elided by the optimizer
+        arm();
+        std::free(allocate(16));
+        return disarm().allocations != 0;
+    }
+};
+
+} // namespace logZ
+
+#ifdef LOGZ_ALLOC_COUNTER_INTERPOSE
+
+// glibc entry points of the real allocator
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) noexcept {
+    logZ::detail::on_alloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    logZ::detail::on_alloc(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    logZ::detail::on_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    logZ::detail::on_alloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    logZ::detail::on_alloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) noexcept {
+    logZ::detail::on_alloc(size);
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* ptr = __libc_memalign(alignment, size);
+    if (ptr == nullptr) {
+        return ENOMEM;
+    }
+    *result = ptr;
+    return 0;
+}
+
+void free(void* ptr) noexcept {
+    logZ::detail::on_free(ptr);
+    __libc_free(ptr);
+}
+}
+
+#endif // LOGZ_ALLOC_COUNTER_INTERPOSE
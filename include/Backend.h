@@ -1,7 +1,19 @@
 #pragma once
 
 #include "Decoder.h"
+#include "CallSiteStats.h"
+#include "CallSite.h"
+#include "Metrics.h"
+#include "Subscriber.h"
+#include "TraceSink.h"
+#include "Recovery.h"
+#include "StatsPage.h"
+#include "BackendProfiler.h"
+#include "FormatPool.h"
+#include "Probes.h"
 #include "Queue.h"
+#include "PerCpuQueues.h"
+#include "MpscRing.h"
 #include "Sinker.h"
 #include "StringRingBuffer.h"
 #include "LogTypes.h"
@@ -13,11 +25,18 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
 #include <algorithm>
 #include <iterator>
 #include <unordered_map>
 #include <unordered_set>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
 #include <pthread.h>  // For pthread_setaffinity_np
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace logZ {
 
@@ -47,8 +66,14 @@ private:
         std::unique_ptr<Queue> queue;              // Backend owns the Queue
         std::atomic<bool> orphaned{false};         // Set to true when thread exits (queue becomes orphaned)
         std::thread::id owner_thread_id;           // Thread ID for debugging
+        std::atomic<LogLevel>* thread_level{nullptr};  // Owner's TLS level threshold (nullptr once orphaned)
+        std::atomic<bool>* level_explicit{nullptr};    // Owner's TLS "level set explicitly" flag (same lifetime)
         uint64_t created_timestamp;                // Creation time
         uint64_t orphaned_timestamp{0};           // When thread exited (queue became orphaned)
+        std::string context;                       // Current ScopedContext prefix (backend thread only)
+        uint32_t os_tid{0};                        // Owner's OS thread id (trace track)
+        std::string thread_name;                   // Owner's name at registration (trace track name)
+        uint64_t quota_reported{0};                // ByteQuota::rejected already reported (backend thread)
         
         explicit QueueWrapper(std::unique_ptr<Queue> q, std::thread::id tid)
             : queue(std::move(q))
@@ -88,12 +113,27 @@ public:
         auto empty = std::make_shared<std::vector<std::shared_ptr<QueueWrapper>>>();
         m_snapshot_list = empty;
         m_current_list = empty;
+
+        if constexpr (LOGZ_PER_CPU_QUEUES) {
+            init_per_cpu_queues();
+        }
     }
 
     ~Backend() {
         stop();
+        close_trace_file();
         // Remove all remaining queues
         remove_all_queues();
+        // Clean shutdown: ring files are gone, so is the run directory
+        if (!persistent_dir_.empty()) {
+            call_site_table_.close();
+            std::error_code ec;
+            std::filesystem::remove(persistent_dir_ + "/callsites", ec);
+            std::filesystem::remove(persistent_dir_, ec);
+        }
+        if (event_fd_ >= 0) {
+            ::close(event_fd_);
+        }
     }
     
     // Disable copy and move
@@ -106,18 +146,34 @@ public:
      * @brief Allocate a new Queue for a worker thread
      * Called when a thread first calls LOG_xxx
      * 
+     * @param thread_level The thread's TLS level threshold, so set_thread_level()
+     *                     can change it from other threads (optional)
+     * @param level_explicit The thread's TLS flag marking an explicitly set level,
+     *                       which set_default_thread_level() leaves alone (optional)
      * @return Queue* Raw pointer for the thread to use (Borrower)
      *         Backend retains ownership via shared_ptr
      */
-    Queue* allocate_queue_for_thread() {
+    Queue* allocate_queue_for_thread(std::atomic<LogLevel>* thread_level = nullptr,
+                                     std::atomic<bool>* level_explicit = nullptr) {
         std::lock_guard<std::mutex> lock(m_writer_mutex);
         
         // Create Queue and wrap in QueueWrapper
         auto wrapper = std::make_shared<QueueWrapper>(
-            std::make_unique<Queue>(4096),  // Initial 4KB capacity
+            persistent_dir_.empty()
+                ? std::make_unique<Queue>(4096)  // Initial 4KB capacity
+                : std::make_unique<Queue>(4096, persistent_dir_ + "/queue-" + std::to_string(persistent_queue_count_++)),
             std::this_thread::get_id()
         );
+        wrapper->thread_level = thread_level;
+        wrapper->level_explicit = level_explicit;
+        apply_quota(wrapper->queue->quota(), default_quota_bytes_per_sec_, default_quota_burst_bytes_);
+        wrapper->os_tid = static_cast<uint32_t>(::gettid());
+        char name[16] = {};
+        if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+            wrapper->thread_name = name;
+        }
         Queue* raw_ptr = wrapper->queue.get();
+        LOGZ_PROBE2(queue_register, raw_ptr, wrapper->os_tid);
         
         // Add to current_list
         // Check if m_snapshot_list also references it (Copy-on-Write needed)
@@ -137,6 +193,13 @@ public:
         return raw_ptr;
     }
     
+    /**
+     * @brief Get the per-CPU producer queues (only valid with LOGZ_PER_CPU_QUEUES)
+     */
+    PerCpuQueues& per_cpu_queues() {
+        return *per_cpu_queues_;
+    }
+
     /**
      * @brief Mark a Queue as orphaned (thread exiting)
      * Called by thread_local destructor when thread exits
@@ -159,7 +222,12 @@ public:
                 if (wrapper->orphaned.compare_exchange_strong(expected, true)) {
                     // First time marking as orphaned
                     wrapper->orphaned_timestamp = get_current_timestamp_ns();
+                    record_queue_lifetime(*wrapper);
+                    LOGZ_PROBE1(queue_orphan, queue);
                 }
+                // Thread-local storage goes away with the thread
+                wrapper->thread_level = nullptr;
+                wrapper->level_explicit = nullptr;
                 
                 // Don't remove from current_list here!
                 // Let Backend discover it via orphaned flag
@@ -174,114 +242,997 @@ public:
     }
 
     /**
-     * @brief Start the backend consumer thread
-     * @param cpu_id CPU core ID to bind to (optional, -1 means no binding)
+     * @brief Set the runtime level threshold of another thread
+     * @param tid Thread to change (must have logged at least once, i.e. own a queue)
+     * @param level Minimum level the thread logs from now on
+     * @return true if the thread was found
+     * 
+     * The new level is stored in the thread's TLS; its hot path is unchanged.
+     * Like Logger::set_thread_level(), it makes the level explicit, so later
+     * set_default_thread_level() calls skip the thread.
+     * Threads on the shared ring or per-CPU queues are not registered and can
+     * only change their own level (Logger::set_thread_level()).
+     */
+    bool set_thread_level(std::thread::id tid, LogLevel level) {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        bool found = false;
+        for (const auto& wrapper : *m_current_list) {
+            if (wrapper->owner_thread_id == tid && wrapper->thread_level != nullptr) {
+                if (wrapper->level_explicit != nullptr) {
+                    wrapper->level_explicit->store(true, std::memory_order_relaxed);
+                }
+                wrapper->thread_level->store(level, std::memory_order_relaxed);
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    /**
+     * @brief Set the level threshold of all registered threads and of threads yet to log
+     * @param level New default level (the compile-time LOGZ_MIN_LEVEL still applies)
+     * 
+     * Threads whose level was set explicitly (set_thread_level()) keep it.
+     */
+    void set_default_thread_level(LogLevel level) {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        default_thread_level_.store(level, std::memory_order_relaxed);
+        for (const auto& wrapper : *m_current_list) {
+            if (wrapper->thread_level != nullptr &&
+                (wrapper->level_explicit == nullptr || !wrapper->level_explicit->load(std::memory_order_relaxed))) {
+                wrapper->thread_level->store(level, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Level threshold a thread starts with (read once per thread by Logger)
+     */
+    LogLevel default_thread_level() const {
+        return default_thread_level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Limit the bytes per second a thread may enqueue
+     * @param tid Thread to limit (its Queue's token bucket)
+     * @param bytes_per_sec Limit in encoded bytes per second (0: unlimited)
+     * @param burst_bytes Bucket size (0: one second worth of bytes)
+     * @return true if the thread has a registered queue
+     * 
+     * Entries over quota are not queued; they are counted per thread
+     * (get_quota_rejections()) and reported in the log once per second.
+     * Threads on per-CPU queues or on the shared ring are not limited.
+     */
+    bool set_thread_quota(std::thread::id tid, uint64_t bytes_per_sec, uint64_t burst_bytes = 0) {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        bool found = false;
+        for (const auto& wrapper : *m_current_list) {
+            if (wrapper->owner_thread_id == tid && wrapper->thread_level != nullptr) {
+                apply_quota(wrapper->queue->quota(), bytes_per_sec, burst_bytes);
+                found = true;
+            }
+        }
+        update_quotas_enabled();
+        return found;
+    }
+
+    /**
+     * @brief Set the byte quota of all registered threads and of threads yet to log
+     */
+    void set_default_thread_quota(uint64_t bytes_per_sec, uint64_t burst_bytes = 0) {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        default_quota_bytes_per_sec_ = bytes_per_sec;
+        default_quota_burst_bytes_ = burst_bytes;
+        for (const auto& wrapper : *m_current_list) {
+            if (wrapper->thread_level != nullptr) {
+                apply_quota(wrapper->queue->quota(), bytes_per_sec, burst_bytes);
+            }
+        }
+        update_quotas_enabled();
+    }
+
+    /**
+     * @brief Whether a byte quota is set (the default, or a live thread's own)
+     */
+    bool quotas_enabled() const {
+        return quotas_enabled_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Entries rejected by a thread's byte quota
+     */
+    struct QuotaRejections {
+        std::thread::id thread;
+        uint32_t os_tid;
+        std::string thread_name;
+        uint64_t rejected;          // Total since the thread registered
+    };
+
+    /**
+     * @brief Per-thread counts of entries dropped by byte quotas (threads with drops only)
+     */
+    std::vector<QuotaRejections> get_quota_rejections() {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        std::vector<QuotaRejections> result;
+        for (const auto& wrapper : *m_current_list) {
+            uint64_t rejected = wrapper->queue->quota().rejected.load(std::memory_order_relaxed);
+            if (rejected > 0) {
+                result.push_back({wrapper->owner_thread_id, wrapper->os_tid, wrapper->thread_name, rejected});
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Get the shared MPSC ring used by transient threads
+     * Created on first use; the ring lives as long as the Backend
+     */
+    MpscRing& shared_ring() {
+        MpscRing* ring = shared_ring_ptr_.load(std::memory_order_acquire);
+        if (ring != nullptr) [[likely]] {
+            return *ring;
+        }
+
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        if (!shared_ring_) {
+            shared_ring_ = std::make_unique<MpscRing>(SHARED_RING_CAPACITY);
+            shared_ring_ptr_.store(shared_ring_.get(), std::memory_order_release);
+        }
+        return *shared_ring_;
+    }
+
+    /**
+     * @brief Place new threads on the shared ring after repeated short-lived registrations
+     * @param threshold Number of queues orphaned within SHORT_LIVED_QUEUE_NS of
+     *                  their creation before switching (0 disables, the default)
+     * 
+     * Once switched, a new thread logs into the shared ring and only gets its
+     * own Queue after it has logged a few dozen entries. Setting 0 also
+     * forgets the short-lived queues counted so far, so re-enabling starts over.
+     */
+    void set_auto_transient_threshold(size_t threshold) {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        auto_transient_threshold_ = threshold;
+        if (threshold == 0) {
+            short_lived_queues_ = 0;
+            transient_by_default_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Check if new threads start on the shared ring (called by Logger slow path)
+     */
+    bool transient_by_default() const {
+        return transient_by_default_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Start the backend consumer thread
+     * @param cpu_id CPU core ID to bind to (optional, -1 means no binding)
+     */
+    void start(int cpu_id = -1) {
+        if (running_.exchange(true)) {
+            return; // Already running
+        }
+
+        consumer_thread_ = std::thread([this, cpu_id]() {
+            // Set CPU affinity if cpu_id is specified
+            if (cpu_id >= 0) {
+                cpu_set_t cpuset;
+                CPU_ZERO(&cpuset);
+                CPU_SET(cpu_id, &cpuset);
+                
+                pthread_t thread = pthread_self();
+                int result = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
+                
+                if (result != 0) {
+                    // Log error but continue execution
+                    // In production, you might want to handle this differently
+                }
+            }
+            
+            this->consume_loop();
+        });
+    }
+
+    /**
+     * @brief Format entries on worker threads (takes effect at the next start())
+     * @param workers Number of format workers (0: format on the backend thread)
+     * 
+     * The backend thread still merges the queues by timestamp, then hands
+     * the entries to the workers in numbered chunks and writes the finished
+     * chunks in sequence order: one globally ordered file, with decoding
+     * spread over several cores. Worth it once decoding, not merging, limits
+     * backend throughput. poll() and draining without a consumer thread
+     * always format inline.
+     */
+    void set_format_workers(size_t workers) {
+        format_workers_.store(workers, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Stop the backend consumer thread
+     * 
+     * Without a consumer thread (poll mode, or never started) the entries
+     * still queued are processed on the calling thread and the output is
+     * flushed, so nothing logged before stop() is lost.
+     */
+    void stop() {
+        stop_and_drain(std::chrono::steady_clock::time_point::max());
+    }
+
+    /**
+     * @brief Stop the backend consumer thread, giving up draining at a deadline
+     * @param deadline Time after which entries still queued are left unwritten
+     * @return true if every queued entry was written before the deadline
+     */
+    bool stop(std::chrono::steady_clock::time_point deadline) {
+        return stop_and_drain(deadline);
+    }
+
+    /**
+     * @brief Block until everything logged up to a TSC is formatted, written and synced
+     * @param cutoff_tsc Entries with a timestamp <= cutoff_tsc must be on disk (default: now)
+     * @param timeout Maximum time to wait
+     * @return true if the barrier was reached, false on timeout
+     * 
+     * The backend keeps running: the barrier is reached once the head of every
+     * producer queue (its watermark) is past cutoff_tsc or the queue is empty,
+     * then the output is flushed and fdatasync'ed. Entries whose producer had
+     * read the TSC but not yet committed when the call started may be missed.
+     * 
+     * Without a consumer thread (poll mode, or not started) the entries are
+     * processed on the calling thread, so this must not run concurrently
+     * with poll().
+     */
+    bool flush_until(uint64_t cutoff_tsc = __rdtsc(),
+                     std::chrono::nanoseconds timeout = std::chrono::seconds(5)) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> lock(flush_mutex_);
+
+        if (!consumer_active_) {
+            // No consumer thread: drain on the caller
+            return drain_on_caller(cutoff_tsc, deadline);
+        }
+
+        uint64_t requested = flush_request_tsc_.load(std::memory_order_relaxed);
+        while (requested < cutoff_tsc &&
+               !flush_request_tsc_.compare_exchange_weak(requested, cutoff_tsc, std::memory_order_relaxed)) {
+        }
+        return flush_cv_.wait_until(lock, deadline, [this, cutoff_tsc]() {
+            return flushed_through_tsc_ >= cutoff_tsc || !consumer_active_;
+        }) && flushed_through_tsc_ >= cutoff_tsc;
+    }
+    
+    /**
+     * @brief Manual poll mode: process up to max_entries log entries on the caller's thread
+     * @param max_entries Budget of entries to process in this call
+     * @return Number of entries processed
+     * 
+     * Alternative to start() for services that already run an event loop.
+     * Must always be called from the same thread, and never while the consumer
+     * thread started by start() is running (returns 0 in that case).
+     * The output is flushed once it has been pending for FLUSH_INTERVAL_NS, so an
+     * idle loop should call poll() at least that often (e.g. as epoll timeout).
+     * When the loop exits, call flush_until() or stop() from the same thread:
+     * up to FLUSH_INTERVAL_NS of output and any entries still queued are
+     * written only then.
+     */
+    size_t poll(size_t max_entries = 1024) {
+        if (running_.load(std::memory_order_relaxed)) [[unlikely]] {
+            return 0;
+        }
+
+        // Consume pending wake-ups (non-blocking, value is irrelevant)
+        if (event_fd_ >= 0) {
+            uint64_t value;
+            [[maybe_unused]] ssize_t r = ::read(event_fd_, &value, sizeof(value));
+        }
+
+        sync_queue_lists();
+
+        size_t processed = 0;
+        while (processed < max_entries && process_one_log()) {
+            ++processed;
+        }
+        run_periodic_tasks();
+
+        // Flush if output has been pending long enough
+        if (!output_buffer_.empty()) {
+            uint64_t now = get_current_timestamp_ns();
+            if (now - last_flush_ns_ >= FLUSH_INTERVAL_NS) {
+                flush_to_disk();
+                last_flush_ns_ = now;
+            }
+        } else {
+            last_flush_ns_ = get_current_timestamp_ns();
+        }
+        return processed;
+    }
+
+    /**
+     * @brief Create the eventfd producers signal in poll mode
+     * @return eventfd to register with epoll (EPOLLIN), or -1 on failure
+     * 
+     * Call once before producers start logging. Producers then pay a fence
+     * only while notifications are enabled, and write to the eventfd only
+     * after prepare_wait() armed it (idle -> pending transition).
+     */
+    int enable_notifications() {
+        if (event_fd_ < 0) {
+            event_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (event_fd_ < 0) {
+                return -1;
+            }
+        }
+        s_notify_enabled_.store(true, std::memory_order_seq_cst);
+        return event_fd_;
+    }
+
+    /**
+     * @brief Get the poll-mode eventfd (-1 if enable_notifications() was not called)
+     */
+    int event_fd() const {
+        return event_fd_;
+    }
+
+    /**
+     * @brief Arm the eventfd before the event loop blocks
+     * @return true if all queues are empty and it is safe to block on event_fd(),
+     *         false if entries are pending and poll() should be called instead
+     */
+    bool prepare_wait() {
+        waiting_.store(true, std::memory_order_seq_cst);
+        sync_queue_lists();
+        for (const auto& wrapper : *m_snapshot_list) {
+            if (!wrapper->queue->is_empty()) {
+                waiting_.store(false, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        MpscRing* shared = shared_ring_ptr_.load(std::memory_order_acquire);
+        if (shared != nullptr && !shared->is_empty()) {
+            waiting_.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Wake a poll-mode backend blocked on event_fd() (called by Logger)
+     * 
+     * Hot path: a single relaxed load when notifications are disabled.
+     */
+    __attribute__((always_inline))
+    static void notify_if_waiting() {
+        if (s_notify_enabled_.load(std::memory_order_relaxed)) [[unlikely]] {
+            get_instance().wake_waiter();
+        }
+    }
+
+    /**
+     * @brief Write TRACE_BEGIN / TRACE_END / TRACE_SCOPE events to a Chrome JSON trace
+     * @param path Trace file (truncated); open in chrome://tracing or ui.perfetto.dev
+     * @return true if the file was created
+     * 
+     * Trace macros are no-ops (one relaxed load) while no trace file is open.
+     * Events need a per-thread queue for their track: with LOGZ_PER_CPU_QUEUES
+     * or on the shared ring they all land on track 0.
+     */
+    bool open_trace_file(const std::string& path) {
+        if (!trace_sink_.open(path)) {
+            return false;
+        }
+        s_tracing_enabled_.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Stop tracing and finish the trace file
+     * Events still queued are discarded.
+     */
+    void close_trace_file() {
+        s_tracing_enabled_.store(false, std::memory_order_relaxed);
+        trace_sink_.close();
+    }
+
+    /**
+     * @brief Check if trace macros should emit events (called by the TRACE_xxx macros)
+     */
+    __attribute__((always_inline))
+    static bool tracing_enabled() {
+        return s_tracing_enabled_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Back the queues of threads that start logging from now on with ring files
+     * 
+     * Files go to run_dir/<pid>/: "queue-N.<node>.ring" per ring (MAP_SHARED,
+     * removed once drained) and the "callsites" table (see Recovery.h). A clean
+     * shutdown removes the directory; after a crash, tools/logz_recover prints
+     * the entries the backend had not consumed. The producer path is unchanged.
+     * 
+     * In this mode the backend also writes out formatted text whenever it goes
+     * idle, so at most one busy burst of text is lost with the process.
+     * Not covered: per-CPU queues and the shared overflow ring (heap memory).
+     * 
+     * @return false if the directory or the call-site table cannot be created
+     */
+    bool enable_persistent_queues(const std::string& run_dir) {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        std::string dir = run_dir + "/" + std::to_string(::getpid());
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        if (ec || !call_site_table_.open(dir + "/callsites")) {
+            return false;
+        }
+        persistent_dir_ = dir;
+        persistent_.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Run directory of enable_persistent_queues() (empty if disabled)
+     */
+    std::string persistent_dir() {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        return persistent_dir_;
+    }
+
+    /**
+     * @brief Flush output buffer to disk
+     */
+    void flush_to_disk() {
+        uint64_t profile_start = profiler_.start();
+        bool timed = stats_page_enabled_.load(std::memory_order_relaxed);
+        auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        size_t flush_bytes = output_buffer_.size();
+        LOGZ_PROBE1(flush_start, flush_bytes);
+        trace_sink_.flush();
+        output_buffer_.flush_to_sinker(&sinker_);
+        LOGZ_PROBE1(flush_done, flush_bytes);
+        // Note: flush_to_sinker already calls sinker->flush()
+        // No need to flush again here
+        if (timed) {
+            last_flush_duration_ns_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            max_flush_duration_ns_ = std::max(max_flush_duration_ns_, last_flush_duration_ns_);
+            ++flush_count_;
+        }
+        profiler_.stop(ProfileStage::FLUSH, profile_start);
+    }
+
+    /**
+     * @brief Backend self-profiling totals (all zero unless built with LOGZ_BACKEND_PROFILING=1)
+     * Per-message stages are sampled; see BackendProfiler.
+     */
+    BackendProfile backend_profile() const {
+        return profiler_.snapshot();
+    }
+
+    void reset_backend_profile() {
+        profiler_.reset();
+    }
+
+    /**
+     * @brief Write a sparse time index next to each log file (YYYY-MM-DD_i.log.idx)
+     * @param block_bytes One entry per block of this many bytes (0: disable)
+     * 
+     * Each entry maps the time of the first line of a block to its file
+     * offset, so tools/logz_seek (or LogIndex) extracts a time range with a
+     * binary search instead of a scan. Call while the backend is stopped.
+     */
+    void enable_time_index(size_t block_bytes = 64 * 1024) {
+        sinker_.enable_index(block_bytes);
+    }
+
+    /**
+     * @brief Path of the log file currently written (stable while the backend is stopped)
+     */
+    std::string current_log_file() const {
+        return sinker_.current_filename();
+    }
+
+    /**
+     * @brief Publish backend health in a shared-memory page for external monitoring
+     * @param path Page file (default: /dev/shm/logz.<pid>), removed with the Backend
+     * @return false if the page cannot be created (or is already enabled)
+     * 
+     * The backend thread refreshes it every STATS_PAGE_INTERVAL_NS with a
+     * seqlock (see StatsPage.h); tools/logz_stats prints it for Prometheus.
+     * Reading it costs the process nothing: no syscalls, no extra thread.
+     */
+    bool enable_stats_page(const std::string& path = {}) {
+        if (stats_page_enabled_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (!stats_page_.open(path.empty() ? "/dev/shm/logz." + std::to_string(::getpid()) : path)) {
+            return false;
+        }
+        stats_page_enabled_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Stop publishing and remove the stats page
+     * @return false if the consumer thread is running (stop() first) or no page is enabled
+     */
+    bool disable_stats_page() {
+        if (running_.load(std::memory_order_acquire) || !stats_page_enabled_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        stats_page_enabled_.store(false, std::memory_order_release);
+        stats_page_.close();
+        return true;
+    }
+
+    /**
+     * @brief Path of the stats page (empty if not enabled)
+     */
+    std::string stats_page_path() const {
+        return stats_page_enabled_.load(std::memory_order_acquire) ? stats_page_.path() : std::string();
+    }
+
+    /**
+     * @brief Read raw bytes from output buffer
+     * @param out Buffer to write to
+     * @param max_length Maximum bytes to read
+     * @return Number of bytes actually read
+     */
+    size_t read_output(std::byte* out, size_t max_length) {
+        return output_buffer_.read(out, max_length);
+    }
+
+    /**
+     * @brief Check if output buffer is empty
+     */
+    bool output_empty() const {
+        return output_buffer_.empty();
+    }
+
+    /**
+     * @brief Get the number of dropped messages
+     * @return Total count of messages that couldn't be queued
+     */
+    uint64_t get_dropped_count() const {
+        return dropped_messages_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Reset the dropped messages counter
+     */
+    void reset_dropped_count() {
+        dropped_messages_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Increment the dropped messages counter (called by Logger)
+     */
+    void increment_dropped_count() {
+        dropped_messages_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Enable or disable per-call-site statistics (disabled by default)
+     * Counting happens on the backend thread only; producers are unaffected.
+     */
+    void enable_call_site_stats(bool enable) {
+        call_site_stats_enabled_.store(enable, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the noisiest call sites
+     * @param k Maximum number of rows (0 returns all)
+     * @return Rows sorted by formatted bytes (descending)
+     */
+    std::vector<CallSiteStat> get_top_call_sites(size_t k = 10) const {
+        return call_site_stats_.top(k);
+    }
+
+    /**
+     * @brief Reset all call-site counters
+     */
+    void reset_call_site_stats() {
+        call_site_stats_.reset();
+    }
+
+    /**
+     * @brief Periodically write the top-K call sites into the log output
+     * @param interval Dump interval (0 disables the dump)
+     * @param top_k Number of call sites per dump
+     * 
+     * Also enables call-site statistics when interval is non-zero.
+     * Set before start() or from the polling thread.
+     */
+    void set_call_site_report_interval(std::chrono::milliseconds interval, size_t top_k = 10) {
+        report_interval_ns_ = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count());
+        report_top_k_ = top_k;
+        next_report_ns_ = get_current_timestamp_ns() + report_interval_ns_;
+        if (report_interval_ns_ > 0) {
+            enable_call_site_stats(true);
+        }
+    }
+
+    /**
+     * @brief Attach an in-process consumer of decoded entries
+     * @param subscriber Callback run on the backend thread for every entry
+     * @return Id for remove_subscriber()
+     * 
+     * The callback gets level, TSC, call-site format and a typed view of the
+     * encoded arguments; nothing is rendered to text for it. With no
+     * subscriber registered the backend pays one relaxed load per entry.
+     */
+    size_t add_subscriber(LogSubscriber subscriber) {
+        return subscribers_.add(std::move(subscriber));
+    }
+
+    /**
+     * @brief Detach a subscriber
+     * @return true if the id was registered
+     */
+    bool remove_subscriber(size_t id) {
+        return subscribers_.remove(id);
+    }
+
+    /**
+     * @brief Count the messages of matching call sites
+     * @param name Metric name
+     * @param pattern Shell glob matched against the format string
+     * @param drop_text Also remove matching lines from the text output
+     */
+    void add_metric_counter(const std::string& name, const std::string& pattern, bool drop_text = false) {
+        metrics_.add_counter(name, pattern, drop_text);
+        metrics_enabled_.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Build a histogram of one numeric argument of matching call sites
+     * @param name Metric name
+     * @param pattern Shell glob matched against the format string
+     * @param arg_index Index of the observed LOG_xxx argument (0 = first), or
+     *                  MetricsAggregator::LAST_ARG
+     * @param bounds Bucket upper bounds
+     * @param drop_text Also remove matching lines from the text output
+     * 
+     * The argument is read from the encoded entry, not parsed from text.
+     */
+    void add_metric_histogram(const std::string& name, const std::string& pattern, size_t arg_index,
+                              std::vector<double> bounds, bool drop_text = false) {
+        metrics_.add_histogram(name, pattern, arg_index, std::move(bounds), drop_text);
+        metrics_enabled_.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Build a latency histogram (ns) of matching LOG_SCOPE_TIMER call sites
+     * @param name Metric name
+     * @param pattern Shell glob matched against the format string
+     * @param bounds_ns Bucket upper bounds in nanoseconds
+     * @param drop_text Also remove matching lines from the text output
+     */
+    void add_scope_timer_histogram(const std::string& name, const std::string& pattern,
+                                   std::vector<double> bounds_ns, bool drop_text = false) {
+        add_metric_histogram(name, pattern, MetricsAggregator::LAST_ARG, std::move(bounds_ns), drop_text);
+    }
+
+    /**
+     * @brief Get the current values of all metrics
+     */
+    std::vector<MetricSnapshot> get_metrics() const {
+        return metrics_.snapshot();
+    }
+
+    /**
+     * @brief Zero all metric values
+     */
+    void reset_metrics() {
+        metrics_.reset();
+    }
+
+    /**
+     * @brief Periodically write all metrics into the log output and reset them
+     * @param interval Flush interval (0 disables the flush)
+     * 
+     * Set before start() or from the polling thread.
+     */
+    void set_metrics_flush_interval(std::chrono::milliseconds interval) {
+        metrics_interval_ns_ = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count());
+        next_metrics_ns_ = get_current_timestamp_ns() + metrics_interval_ns_;
+    }
+
+    /**
+     * @brief Enable or disable LOG_xxx call sites at runtime
+     * @param pattern Shell glob matched against "filename:line" and the format string
+     * @param enabled New state
+     * @return Number of call sites matched
+     */
+    size_t set_call_sites_enabled(const std::string& pattern, bool enabled) {
+        return CallSiteRegistry::instance().set_enabled(pattern, enabled);
+    }
+
+    /**
+     * @brief Watch a control file for call-site switches
+     * @param path File to watch (empty string stops watching)
+     * 
+     * The file is re-applied top to bottom whenever its mtime changes
+     * (checked about once per second by the backend). One command per line:
+     *   disable <pattern>
+     *   enable <pattern>
+     * Lines starting with '#' are ignored. Set before start() or from the
+     * polling thread.
+     */
+    void watch_control_file(const std::string& path) {
+        control_file_ = path;
+        control_file_mtime_ns_ = 0;
+        next_control_check_ns_ = 0;
+    }
+
+    /**
+     * @brief Get the number of logs written
+     * @return Total count of logs that have been written
+     */
+    uint64_t get_log_count() const {
+        return log_count_;
+    }
+
+    /**
+     * @brief Reset the log counter
+     */
+    void reset_log_count() {
+        log_count_ = 0;
+    }
+
+private:
+    /**
+     * @brief Signal the eventfd if the backend armed it in prepare_wait()
+     * Pairs with prepare_wait(): the fence orders the producer's commit before
+     * reading waiting_, so either the producer sees the flag or the backend
+     * sees the entry.
+     */
+    __attribute__((noinline))
+    void wake_waiter() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_.load(std::memory_order_relaxed) &&
+            waiting_.exchange(false, std::memory_order_acq_rel)) {
+            uint64_t one = 1;
+            [[maybe_unused]] ssize_t r = ::write(event_fd_, &one, sizeof(one));
+        }
+    }
+
+    /**
+     * @brief Run time-based housekeeping (backend thread)
+     * Called every PERIODIC_CHECK_ITERATIONS iterations of consume_loop() and on
+     * each poll(), so the clock is read rarely.
+     */
+    void run_periodic_tasks() {
+        uint64_t now = get_current_timestamp_ns();
+        if (stats_page_enabled_.load(std::memory_order_acquire) && now >= next_stats_ns_) {
+            next_stats_ns_ = now + STATS_PAGE_INTERVAL_NS;
+            publish_stats(now);
+        }
+        if (quotas_enabled_.load(std::memory_order_relaxed) && now >= next_quota_report_ns_) {
+            next_quota_report_ns_ = now + QUOTA_REPORT_INTERVAL_NS;
+            report_quota_rejections();
+        }
+        if (report_interval_ns_ > 0 && now >= next_report_ns_) {
+            next_report_ns_ = now + report_interval_ns_;
+            dump_call_site_stats();
+        }
+        if (metrics_interval_ns_ > 0 && now >= next_metrics_ns_) {
+            next_metrics_ns_ = now + metrics_interval_ns_;
+            dump_metrics();
+        }
+        if (!control_file_.empty() && now >= next_control_check_ns_) {
+            next_control_check_ns_ = now + CONTROL_FILE_CHECK_NS;
+            check_control_file();
+        }
+    }
+
+    /**
+     * @brief Re-apply the control file if it changed since the last check
      */
-    void start(int cpu_id = -1) {
-        if (running_.exchange(true)) {
-            return; // Already running
+    void check_control_file() {
+        struct stat st;
+        if (::stat(control_file_.c_str(), &st) != 0) {
+            return;
+        }
+        uint64_t mtime_ns = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000ull + st.st_mtim.tv_nsec;
+        if (mtime_ns == control_file_mtime_ns_) {
+            return;
         }
+        control_file_mtime_ns_ = mtime_ns;
 
-        consumer_thread_ = std::thread([this, cpu_id]() {
-            // Set CPU affinity if cpu_id is specified
-            if (cpu_id >= 0) {
-                cpu_set_t cpuset;
-                CPU_ZERO(&cpuset);
-                CPU_SET(cpu_id, &cpuset);
-                
-                pthread_t thread = pthread_self();
-                int result = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
-                
-                if (result != 0) {
-                    // Log error but continue execution
-                    // In production, you might want to handle this differently
-                }
+        std::ifstream file(control_file_);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string command, pattern;
+            if (!(fields >> command >> pattern) || command[0] == '#') {
+                continue;
             }
-            
-            this->consume_loop();
-        });
+            if (command == "enable") {
+                set_call_sites_enabled(pattern, true);
+            } else if (command == "disable") {
+                set_call_sites_enabled(pattern, false);
+            }
+        }
     }
 
     /**
-     * @brief Stop the backend consumer thread
+     * @brief Write the top-K call sites into the log output
      */
-    void stop() {
-        if (!running_.exchange(false)) {
-            return; // Not running
-        }
-
-        if (consumer_thread_.joinable()) {
-            consumer_thread_.join();
-        }
+    void dump_call_site_stats() {
+        auto rows = call_site_stats_.top(report_top_k_);
         
-        // Flush remaining data to disk
-        flush_to_disk();
-    }
-    
-    /**
-     * @brief Flush output buffer to disk
-     */
-    void flush_to_disk() {
-        output_buffer_.flush_to_sinker(&sinker_);
-        // Note: flush_to_sinker already calls sinker->flush()
-        // No need to flush again here
+        auto writer = report_writer();
+        writer.append("[STATS] ");
+        writer.append(format_timestamp(__rdtsc()));
+        writer.append(" top call sites by formatted bytes\n");
+        
+        size_t rank = 0;
+        for (const auto& row : rows) {
+            writer.append("[STATS]   #");
+            writer.append(std::to_string(++rank));
+            writer.append(" count=");
+            writer.append(std::to_string(row.count));
+            writer.append(" encoded_bytes=");
+            writer.append(std::to_string(row.encoded_bytes));
+            writer.append(" formatted_bytes=");
+            writer.append(std::to_string(row.formatted_bytes));
+            writer.append(" format=\"");
+            writer.append(row.format);
+            writer.append("\"\n");
+        }
     }
 
     /**
-     * @brief Read raw bytes from output buffer
-     * @param out Buffer to write to
-     * @param max_length Maximum bytes to read
-     * @return Number of bytes actually read
+     * @brief Refresh the shared-memory stats page (backend thread)
      */
-    size_t read_output(std::byte* out, size_t max_length) {
-        return output_buffer_.read(out, max_length);
+    void publish_stats(uint64_t now_ns) {
+        uint64_t values[static_cast<size_t>(StatsField::COUNT)] = {};
+        auto set = [&values](StatsField field, uint64_t value) {
+            values[static_cast<size_t>(field)] = value;
+        };
+
+        uint64_t now_tsc = __rdtsc();
+        uint64_t oldest_tsc = now_tsc;
+        uint64_t memory = 0, queued = 0, rejected = 0;
+        for (const auto& wrapper : *m_snapshot_list) {
+            Queue& queue = *wrapper->queue;
+            memory += queue.memory_bytes();
+            queued += queue.available_read();
+            rejected += queue.quota().rejected.load(std::memory_order_relaxed);
+            if (std::byte* head = queue.read(sizeof(Metadata))) {
+                oldest_tsc = std::min(oldest_tsc, reinterpret_cast<const Metadata*>(head)->timestamp);
+            }
+        }
+
+        set(StatsField::UPDATE_TIME_NS, now_ns);
+        set(StatsField::ENTRIES_PROCESSED, log_count_);
+        set(StatsField::DROPPED_MESSAGES, dropped_messages_.load(std::memory_order_relaxed));
+        set(StatsField::QUOTA_REJECTED, rejected);
+        set(StatsField::QUEUE_COUNT, m_snapshot_list->size());
+        set(StatsField::QUEUE_MEMORY_BYTES, memory);
+        set(StatsField::QUEUED_BYTES, queued);
+        set(StatsField::BACKEND_LAG_NS, static_cast<uint64_t>(
+            static_cast<double>(now_tsc - oldest_tsc) * TscCalibration::instance().tsc_to_ns_ratio));
+        set(StatsField::FLUSH_COUNT, flush_count_);
+        set(StatsField::LAST_FLUSH_NS, last_flush_duration_ns_);
+        set(StatsField::MAX_FLUSH_NS, max_flush_duration_ns_);
+        stats_page_.publish(values);
     }
 
     /**
-     * @brief Check if output buffer is empty
+     * @brief Write one line per thread whose byte quota dropped entries since the last report
      */
-    bool output_empty() const {
-        return output_buffer_.empty();
+    void report_quota_rejections() {
+        for (const auto& wrapper : *m_snapshot_list) {
+            uint64_t rejected = wrapper->queue->quota().rejected.load(std::memory_order_relaxed);
+            if (rejected == wrapper->quota_reported) {
+                continue;
+            }
+            auto writer = report_writer();
+            writer.append("[WARN] ");
+            writer.append(format_timestamp(__rdtsc()));
+            writer.append(" byte quota exceeded on thread ");
+            writer.append(std::to_string(wrapper->os_tid));
+            if (!wrapper->thread_name.empty()) {
+                writer.append(" (");
+                writer.append(wrapper->thread_name);
+                writer.append(")");
+            }
+            writer.append(": ");
+            writer.append(std::to_string(rejected - wrapper->quota_reported));
+            writer.append(" entries dropped\n");
+            wrapper->quota_reported = rejected;
+        }
     }
 
     /**
-     * @brief Get the number of dropped messages
-     * @return Total count of messages that couldn't be queued
+     * @brief Recompute quotas_enabled_ from the default and the live threads' limits
+     * Called with m_writer_mutex held, after every quota change, so removing the
+     * last quota also stops the periodic rejection reports.
      */
-    uint64_t get_dropped_count() const {
-        return dropped_messages_.load(std::memory_order_relaxed);
+    void update_quotas_enabled() {
+        bool enabled = default_quota_bytes_per_sec_ != 0;
+        for (const auto& wrapper : *m_current_list) {
+            if (enabled) {
+                break;
+            }
+            enabled = wrapper->thread_level != nullptr && wrapper->queue->quota().limited();
+        }
+        quotas_enabled_.store(enabled, std::memory_order_relaxed);
     }
 
     /**
-     * @brief Reset the dropped messages counter
+     * @brief Set up a queue's token bucket (burst 0: one second worth of bytes)
      */
-    void reset_dropped_count() {
-        dropped_messages_.store(0, std::memory_order_relaxed);
+    static void apply_quota(ByteQuota& quota, uint64_t bytes_per_sec, uint64_t burst_bytes) {
+        quota.burst_bytes.store(burst_bytes != 0 ? burst_bytes : bytes_per_sec, std::memory_order_relaxed);
+        quota.bytes_per_sec.store(bytes_per_sec, std::memory_order_relaxed);
     }
 
     /**
-     * @brief Increment the dropped messages counter (called by Logger)
+     * @brief Write all metrics into the log output and start a new window
      */
-    void increment_dropped_count() {
-        dropped_messages_.fetch_add(1, std::memory_order_relaxed);
+    void dump_metrics() {
+        auto metrics = metrics_.snapshot();
+        metrics_.reset();
+        
+        auto writer = report_writer();
+        for (const auto& metric : metrics) {
+            writer.append("[METRIC] ");
+            writer.append(format_timestamp(__rdtsc()));
+            writer.append(" ");
+            writer.append(metric.name);
+            writer.append(" count=");
+            writer.append(std::to_string(metric.count));
+            if (!metric.buckets.empty()) {
+                writer.append(" sum=");
+                writer.append(std::to_string(metric.sum));
+                writer.append(" min=");
+                writer.append(std::to_string(metric.min));
+                writer.append(" max=");
+                writer.append(std::to_string(metric.max));
+                for (size_t i = 0; i < metric.buckets.size(); ++i) {
+                    writer.append(" le_");
+                    writer.append(i < metric.bounds.size() ? std::to_string(metric.bounds[i]) : std::string("inf"));
+                    writer.append("=");
+                    writer.append(std::to_string(metric.buckets[i]));
+                }
+            }
+            writer.append("\n");
+        }
     }
 
     /**
-     * @brief Get the number of logs written
-     * @return Total count of logs that have been written
+     * @brief Count short-lived queues for the automatic transient mode
+     * Called with m_writer_mutex held
      */
-    uint64_t get_log_count() const {
-        return log_count_;
+    void record_queue_lifetime(const QueueWrapper& wrapper) {
+        if (auto_transient_threshold_ == 0) {
+            return;
+        }
+        if (wrapper.orphaned_timestamp - wrapper.created_timestamp < SHORT_LIVED_QUEUE_NS &&
+            ++short_lived_queues_ >= auto_transient_threshold_) {
+            transient_by_default_.store(true, std::memory_order_relaxed);
+        }
     }
 
     /**
-     * @brief Reset the log counter
+     * @brief Apply pending queue registrations/removals to the snapshot list
+     * Only atomic loads on the hot path (no lock unless a flag is set)
      */
-    void reset_log_count() {
-        log_count_ = 0;
+    void sync_queue_lists() {
+        if (m_add_flag.load(std::memory_order_acquire)) [[unlikely]] {
+            add_to_snapshot_list();
+        }
+        if (m_delete_flag.load(std::memory_order_acquire)) [[unlikely]] {
+            remove_from_snapshot_list();
+        }
     }
 
-private:
     /**
      * @brief Add new queues to snapshot list
      * Called when m_add_flag is set
@@ -319,22 +1270,43 @@ private:
      */
     void consume_loop() {
         static int counter = 0;
+        uint32_t periodic_counter = 0;
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            consumer_active_ = true;
+        }
+        size_t format_workers = format_workers_.load(std::memory_order_relaxed);
+        if (format_workers > 0) {
+            format_pool_ = std::make_unique<FormatPool>(format_workers, &format_line);
+        }
         
         while (running_.load(std::memory_order_relaxed)) {
-            // Check add flag (only atomic load, no lock)
-            // Hot path: Usually no new queues
-            if (m_add_flag.load(std::memory_order_acquire)) [[unlikely]] {
-                add_to_snapshot_list();  // Add new queue to snapshot
-            }
-            
-            // Check delete flag (only atomic load, no lock)
-            // Hot path: Usually no queues to remove
-            if (m_delete_flag.load(std::memory_order_acquire)) [[unlikely]] {
-                remove_from_snapshot_list();  // Remove orphaned queues from snapshot
-            }
+            // Check add/delete flags (only atomic loads, no lock)
+            // Hot path: Usually no new or orphaned queues
+            sync_queue_lists();
             
             bool processed_any = process_one_log();
 
+            // Format workers: idle hands off the partial chunk; write whatever is finished
+            if (format_pool_ != nullptr) [[unlikely]] {
+                if (!processed_any) {
+                    format_pool_->submit();
+                }
+                write_format_chunks(false);
+            }
+
+            // Pending flush_until() barrier
+            uint64_t flush_request = flush_request_tsc_.load(std::memory_order_relaxed);
+            if (flush_request > flushed_through_tsc_) [[unlikely]] {
+                complete_flush_barrier(flush_request);
+            }
+
+            // Time-based housekeeping, clock read only every N iterations
+            if (++periodic_counter >= PERIODIC_CHECK_ITERATIONS) [[unlikely]] {
+                periodic_counter = 0;
+                run_periodic_tasks();
+            }
+
             // Periodically flush to disk
             if (++counter >= 50000) {  // Every 50000 iterations
                 counter = 0;
@@ -344,23 +1316,163 @@ private:
             // If no work was done, sleep briefly to avoid busy-waiting
             // Hot path: Usually processes something
             if (!processed_any) [[unlikely]] {
+                // Persistent queues: formatted text must not outlive an idle period in memory
+                if (persistent_.load(std::memory_order_relaxed) && !output_buffer_.empty()) {
+                    flush_to_disk();
+                }
+                uint64_t idle_start = profiler_.start();
                 std::this_thread::sleep_for(std::chrono::microseconds(100));
+                profiler_.stop(ProfileStage::IDLE, idle_start);
             }
         }
 
-        // Final sync and drain
-        if (m_add_flag.load(std::memory_order_acquire)) {
-            add_to_snapshot_list();
-        }
-        if (m_delete_flag.load(std::memory_order_acquire)) {
-            remove_from_snapshot_list();
-        }
-        while (process_one_log()) {
+        // Final sync and drain (bounded by stop(deadline) if given)
+        sync_queue_lists();
+        int64_t deadline_ns = stop_deadline_ns_.load(std::memory_order_relaxed);
+        size_t drained = 0;
+        bool timed_out = false;
+        while (!timed_out) {
             // Keep processing until all queues are empty
+            if (!process_one_log()) {
+                flush_to_disk();  // Output buffer full: make room
+                if (!process_one_log()) {
+                    break;
+                }
+            }
+            timed_out = deadline_ns != 0 && (++drained & 255) == 0 &&
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count() >= deadline_ns;
         }
+        drained_on_stop_ = !timed_out && queues_flushed_through(UINT64_MAX);
         
         // Final flush
+        if (format_pool_ != nullptr) {
+            write_format_chunks(true);
+        }
+        if (quotas_enabled_.load(std::memory_order_relaxed)) {
+            report_quota_rejections();
+        }
+        if constexpr (BackendProfiler::enabled) {
+            auto writer = report_writer();
+            writer.append("[PROFILE] ");
+            writer.append(format_timestamp(__rdtsc()));
+            writer.append(" ");
+            writer.append(profiler_.snapshot().to_string());
+            writer.append("\n");
+        }
+        flush_to_disk();
+        format_pool_.reset();
+
+        // Release flush_until() waiters; later calls drain on their own thread
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            if (drained_on_stop_) {
+                flushed_through_tsc_ = std::max(flushed_through_tsc_,
+                                                flush_request_tsc_.load(std::memory_order_relaxed));
+            }
+            consumer_active_ = false;
+        }
+        flush_cv_.notify_all();
+    }
+
+    /**
+     * @brief Shared body of stop() and stop(deadline)
+     * @return true if every entry queued at this call was written before the deadline
+     */
+    bool stop_and_drain(std::chrono::steady_clock::time_point deadline) {
+        // Published before running_ is cleared: the consumer reads it once its loop exits
+        stop_deadline_ns_.store(deadline == std::chrono::steady_clock::time_point::max() ? 0 :
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    deadline.time_since_epoch()).count(),
+                                std::memory_order_relaxed);
+        if (!running_.exchange(false)) {
+            stop_deadline_ns_.store(0, std::memory_order_relaxed);
+            // No consumer thread: drain on the caller, once a consumer still
+            // finishing a concurrent stop() has released the queues
+            std::unique_lock<std::mutex> lock(flush_mutex_);
+            flush_cv_.wait(lock, [this]() { return !consumer_active_; });
+            return drain_on_caller(UINT64_MAX, deadline);
+        }
+
+        if (consumer_thread_.joinable()) {
+            consumer_thread_.join();
+        }
+        stop_deadline_ns_.store(0, std::memory_order_relaxed);
+
+        // Flush remaining data to disk
+        flush_to_disk();
+        return drained_on_stop_;  // Written by the consumer thread just joined
+    }
+
+    /**
+     * @brief Process entries on the calling thread, then flush (no consumer thread)
+     * @param cutoff_tsc Stop once no queue holds an entry with timestamp <= cutoff_tsc
+     *                   (UINT64_MAX: until every queue is empty)
+     * @param deadline Give up after this time
+     * @return true if the cutoff was reached before the deadline
+     * 
+     * Called with flush_mutex_ held, so flush_until() and stop() do not race.
+     */
+    bool drain_on_caller(uint64_t cutoff_tsc, std::chrono::steady_clock::time_point deadline) {
+        sync_queue_lists();
+        size_t processed = 0;
+        while (!queues_flushed_through(cutoff_tsc)) {
+            if (!process_one_log()) {
+                flush_to_disk();  // Output buffer full: make room
+                if (!process_one_log()) {
+                    break;
+                }
+            }
+            if ((++processed & 255) == 0 && std::chrono::steady_clock::now() >= deadline) {
+                flush_to_disk();
+                return false;
+            }
+        }
+        flush_to_disk();
+        return true;
+    }
+
+    /**
+     * @brief Check whether no queue holds an entry with timestamp <= cutoff_tsc
+     * (consumer side only: peeks at queue heads)
+     */
+    bool queues_flushed_through(uint64_t cutoff_tsc) {
+        for (const auto& wrapper : *m_snapshot_list) {
+            if (!wrapper->queue->is_empty()) {
+                std::byte* meta_buffer = wrapper->queue->read(sizeof(Metadata));
+                if (meta_buffer != nullptr &&
+                    reinterpret_cast<const Metadata*>(meta_buffer)->timestamp <= cutoff_tsc) {
+                    return false;
+                }
+            }
+        }
+        MpscRing* shared = shared_ring_ptr_.load(std::memory_order_acquire);
+        if (shared != nullptr) {
+            std::byte* meta_buffer = shared->read(sizeof(Metadata));
+            if (meta_buffer != nullptr &&
+                reinterpret_cast<const Metadata*>(meta_buffer)->timestamp <= cutoff_tsc) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Flush, sync and wake flush_until() once its cutoff is reached (backend thread)
+     */
+    void complete_flush_barrier(uint64_t requested) {
+        if (!queues_flushed_through(requested)) {
+            return;
+        }
+        if (format_pool_ != nullptr) {
+            write_format_chunks(true);
+        }
         flush_to_disk();
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            flushed_through_tsc_ = requested;
+        }
+        flush_cv_.notify_all();
     }
 
     /**
@@ -371,12 +1483,13 @@ private:
      */
     bool process_one_log() {
         // Poll all registered queues and find the log entry with minimum timestamp
-        Queue* selected_queue = nullptr;
+        QueueWrapper* selected = nullptr;
         uint64_t min_timestamp = UINT64_MAX;
         
         if (output_buffer_.get_free_space() < 32) {
             return false;
         }
+        profiler_.begin_message();
         // Traverse all queue heads to find minimum timestamp
         // LOCK-FREE: Direct traversal of m_snapshot_list, no atomic operations
         for (const auto& wrapper : *m_snapshot_list) {
@@ -386,19 +1499,39 @@ private:
                     const auto* meta = reinterpret_cast<const Metadata*>(meta_buffer);
                     if (meta->timestamp < min_timestamp) {
                         min_timestamp = meta->timestamp;
-                        selected_queue = wrapper->queue.get();
+                        selected = wrapper.get();
                     }
                 }
             }
         }
         
+        // Shared ring for transient threads (exists only once one has logged)
+        MpscRing* shared = shared_ring_ptr_.load(std::memory_order_acquire);
+        if (shared != nullptr) [[unlikely]] {
+            std::byte* meta_buffer = shared->read(sizeof(Metadata));
+            if (meta_buffer != nullptr) {
+                const auto* meta = reinterpret_cast<const Metadata*>(meta_buffer);
+                if (meta->timestamp < min_timestamp) {
+                    // Threads on the shared ring have no per-queue state
+                    profiler_.lap(ProfileStage::MERGE);
+                    process_log_from_queue(shared, meta, nullptr);
+                    profiler_.lap(ProfileStage::BUFFER);
+                    profiler_.end_message();
+                    return true;
+                }
+            }
+        }
+        
         // If found a log entry, process it
-        if (selected_queue != nullptr) {
+        if (selected != nullptr) {
             // Re-read and process the selected queue
-            std::byte* meta_buffer = selected_queue->read(sizeof(Metadata));
+            std::byte* meta_buffer = selected->queue->read(sizeof(Metadata));
             if (meta_buffer != nullptr) {
                 const auto* metadata_ptr = reinterpret_cast<const Metadata*>(meta_buffer);
-                process_log_from_queue(selected_queue, metadata_ptr);
+                profiler_.lap(ProfileStage::MERGE);
+                process_log_from_queue(selected->queue.get(), metadata_ptr, selected);
+                profiler_.lap(ProfileStage::BUFFER);
+                profiler_.end_message();
                 return true;
             }
         }
@@ -409,12 +1542,16 @@ private:
      * @brief Process a specific log entry from a queue
      * @param queue The queue to read from
      * @param metadata The metadata pointer (from peek in process_one_log)
+     * @param wrapper Owner of the queue (nullptr for the shared ring)
      * 
      * Note: metadata_ptr points to data already read in process_one_log().
      * We need to read the complete entry (Metadata + args) again because
      * the previous read() calls in process_one_log() were not committed.
+     * 
+     * QueueT is Queue (per-thread / per-CPU) or MpscRing (shared ring).
      */
-    void process_log_from_queue(Queue* queue, const Metadata* metadata_ptr) {
+    template<typename QueueT>
+    void process_log_from_queue(QueueT* queue, const Metadata* metadata_ptr, QueueWrapper* wrapper) {
         // Copy metadata to stack FIRST (from the peeked metadata)
         Metadata metadata = *metadata_ptr;
         
@@ -435,23 +1572,86 @@ private:
         
         // Use the metadata from the complete entry (in case it differs from peeked one)
         metadata = *actual_metadata;
+
+        // The owner dropped entries right before this one: mark the gap in place
+        if (metadata.dropped_before != 0) [[unlikely]] {
+            if (format_pool_ != nullptr) {
+                FormatPool::append_text(format_chunk(), drop_marker_text(metadata, wrapper));
+            } else {
+                output_buffer_.get_writer(&sinker_).append(drop_marker_text(metadata, wrapper));
+            }
+        }
+        
+        std::string* context = (wrapper != nullptr) ? &wrapper->context : nullptr;
+        if (metadata.kind != EntryKind::LOG) [[unlikely]] {
+            if (metadata.kind == EntryKind::CONTEXT) {
+                // Context change: remember it for the following entries of this queue
+                if (context != nullptr) {
+                    context->assign(DecodedValue<std::string_view>::decode_impl(args_buffer).first);
+                }
+            } else if (metadata.kind == EntryKind::TRACE_BEGIN || metadata.kind == EntryKind::TRACE_END) {
+                trace_sink_.write_event(metadata, args_buffer,
+                                        wrapper != nullptr ? wrapper->os_tid : 0,
+                                        wrapper != nullptr ? std::string_view(wrapper->thread_name) : std::string_view());
+            }
+            // No text line for non-LOG entries
+            queue->commit_read(total_size);
+            return;
+        }
+        
+        if (subscribers_.active()) [[unlikely]] {
+            subscribers_.dispatch(metadata, args_buffer,
+                                  context != nullptr ? std::string_view(*context) : std::string_view());
+        }
+        
+        // Log-to-metrics: may consume the entry without a text line
+        if (metrics_enabled_.load(std::memory_order_relaxed)) [[unlikely]] {
+            if (metrics_.record(metadata.decoder, args_buffer)) {
+                queue->commit_read(total_size);
+                return;
+            }
+        }
         
+        // Format workers: the entry is copied into the current chunk
+        if (format_pool_ != nullptr) [[unlikely]] {
+            FormatChunk& chunk = format_chunk();
+            FormatPool::append_entry(chunk, entry_buffer, total_size,
+                                     context != nullptr ? std::string_view(*context) : std::string_view());
+            chunk.record_sizes |= call_site_stats_enabled_.load(std::memory_order_relaxed);
+            queue->commit_read(total_size);
+            if (chunk.input.size() >= FormatPool::CHUNK_BYTES) {
+                format_pool_->submit();
+            }
+            return;
+        }
+
         // Process the log entry
         auto writer = output_buffer_.get_writer(&sinker_);
+        size_t output_before = output_buffer_.size();
         
         writer.append(level_to_string(metadata.level));
         writer.append(" ");
+        profiler_.lap(ProfileStage::BUFFER);
         writer.append(format_timestamp(metadata.timestamp));
+        profiler_.lap(ProfileStage::TIMESTAMP);
         writer.append(" ");
+        if (context != nullptr && !context->empty()) {
+            writer.append(*context);
+        }
 
         if (metadata.decoder != nullptr) {
             using ActualDecoderFunc = void (*)(const std::byte*, StringRingBuffer::StringWriter&);
             auto actual_decoder = reinterpret_cast<ActualDecoderFunc>(metadata.decoder);
             actual_decoder(args_buffer, writer);
         }
+        profiler_.lap(ProfileStage::DECODE);
         
         writer.append("\n");
         
+        if (call_site_stats_enabled_.load(std::memory_order_relaxed)) [[unlikely]] {
+            call_site_stats_.record(metadata.decoder, total_size, output_buffer_.size() - output_before);
+        }
+        
         // Increment log counter
         ++log_count_;
         
@@ -459,6 +1659,92 @@ private:
         queue->commit_read(total_size);
     }
 
+    /**
+     * @brief "N messages dropped on thread T" line, written before the entry that follows the gap
+     */
+    static std::string drop_marker_text(const Metadata& metadata, const QueueWrapper* wrapper) {
+        std::string text = "[WARN] ";
+        text += format_timestamp(metadata.timestamp);
+        text += " ";
+        text += std::to_string(metadata.dropped_before);
+        text += metadata.dropped_before == UINT16_MAX ? "+ messages dropped on thread " : " messages dropped on thread ";
+        text += std::to_string(wrapper != nullptr ? wrapper->os_tid : 0);
+        if (wrapper != nullptr && !wrapper->thread_name.empty()) {
+            text += " (";
+            text += wrapper->thread_name;
+            text += ")";
+        }
+        text += "\n";
+        return text;
+    }
+
+    /**
+     * @brief Format one LOG entry as a text line (format workers)
+     * Same layout as process_log_from_queue(): "LEVEL HH:MM:SS:mmm [context]message\n"
+     */
+    static void format_line(const Metadata& metadata, const std::byte* args, std::string_view context,
+                            StringRingBuffer::StringWriter& writer) {
+        writer.append(level_to_string(metadata.level));
+        writer.append(" ");
+        writer.append(format_timestamp(metadata.timestamp));
+        writer.append(" ");
+        writer.append(context);
+        if (metadata.decoder != nullptr) {
+            using ActualDecoderFunc = void (*)(const std::byte*, StringRingBuffer::StringWriter&);
+            reinterpret_cast<ActualDecoderFunc>(metadata.decoder)(args, writer);
+        }
+        writer.append("\n");
+    }
+
+    /**
+     * @brief Chunk the merge stage appends to, writing finished chunks while its slot is busy
+     */
+    FormatChunk& format_chunk() {
+        FormatChunk* chunk = format_pool_->fill_chunk();
+        while (chunk == nullptr) {
+            write_format_chunk(*format_pool_->next_done(true));
+            chunk = format_pool_->fill_chunk();
+        }
+        return *chunk;
+    }
+
+    /**
+     * @brief Append finished chunks to the output in sequence order (backend thread)
+     * @param wait Submit the chunk being filled and wait until every chunk is written
+     */
+    void write_format_chunks(bool wait) {
+        if (wait) {
+            format_pool_->submit();
+        }
+        while (FormatChunk* chunk = format_pool_->next_done(wait)) {
+            write_format_chunk(*chunk);
+        }
+    }
+
+    void write_format_chunk(FormatChunk& chunk) {
+        if (output_buffer_.get_free_space() < chunk.text.size()) {
+            flush_to_disk();
+        }
+        chunk.text.move_to(output_buffer_);
+        log_count_ += chunk.lines;
+        for (const auto& sample : chunk.samples) {
+            call_site_stats_.record(sample.decoder, sample.encoded_bytes, sample.formatted_bytes);
+        }
+        format_pool_->release(chunk);
+    }
+
+    /**
+     * @brief Writer for lines the backend produces itself (reports, profile)
+     * With format workers, chunks in flight are written first so the line
+     * lands after every entry merged before it.
+     */
+    StringRingBuffer::StringWriter report_writer() {
+        if (format_pool_ != nullptr) {
+            write_format_chunks(true);
+        }
+        return output_buffer_.get_writer(&sinker_);
+    }
+
     /**
      * @brief Convert log level to string
      */
@@ -549,6 +1835,26 @@ private:
         return std::string(buffer, 12);
     }
     
+    /**
+     * @brief Create one Queue per CPU and register them like per-thread queues
+     * Called from the constructor, before any producer can log.
+     * The queues are never orphaned, so they live as long as the Backend.
+     */
+    void init_per_cpu_queues() {
+        per_cpu_queues_ = std::make_unique<PerCpuQueues>();
+        
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        for (size_t i = 0; i < per_cpu_queues_->size(); ++i) {
+            auto wrapper = std::make_shared<QueueWrapper>(
+                std::make_unique<Queue>(PER_CPU_QUEUE_CAPACITY),
+                std::thread::id()  // Shared by all threads on this CPU
+            );
+            per_cpu_queues_->bind(i, wrapper->queue.get());
+            m_current_list->push_back(std::move(wrapper));
+        }
+        m_add_flag.store(true, std::memory_order_release);
+    }
+
     /**
      * @brief Remove all queues (called in destructor)
      */
@@ -590,6 +1896,94 @@ private:
     std::mutex m_writer_mutex;                                                     // Protects current_list
     std::atomic<bool> m_add_flag{false};                                           // Flag to add new queue to snapshot
     std::atomic<bool> m_delete_flag{false};                                        // Flag to remove orphaned queue from snapshot
+
+    // Per-CPU frontend (LOGZ_PER_CPU_QUEUES)
+    static constexpr size_t PER_CPU_QUEUE_CAPACITY = 64 * 1024;  // Initial capacity per CPU queue
+    std::unique_ptr<PerCpuQueues> per_cpu_queues_;               // Slots borrow Queues owned by the lists above
+
+    // Runtime level threshold for threads that have not set their own
+    std::atomic<LogLevel> default_thread_level_{MinLevel};
+
+    // Call-site statistics
+    static constexpr uint32_t PERIODIC_CHECK_ITERATIONS = 1024;  // consume_loop() iterations between clock reads
+    CallSiteStats call_site_stats_;                              // Per-decoder counters
+    std::atomic<bool> call_site_stats_enabled_{false};           // Record counters in process_log_from_queue()
+    uint64_t report_interval_ns_{0};                             // Periodic top-K dump interval (0: disabled)
+    uint64_t next_report_ns_{0};                                 // Next dump time
+    size_t report_top_k_{10};                                    // Rows per dump
+
+    // Chrome JSON trace output
+    static inline std::atomic<bool> s_tracing_enabled_{false};   // Trace macros check this first
+    TraceSink trace_sink_;                                       // Writes TRACE_xxx entries
+
+    // In-process subscribers
+    SubscriberList subscribers_;                                 // Callbacks over decoded entries (active() checked first)
+
+    // Per-thread byte quotas
+    static constexpr uint64_t QUOTA_REPORT_INTERVAL_NS = 1000000000ull;  // At most one report per second
+    std::atomic<bool> quotas_enabled_{false};                    // Some queue has a quota: report drops
+    uint64_t default_quota_bytes_per_sec_{0};                    // Quota of new threads, under m_writer_mutex
+    uint64_t default_quota_burst_bytes_{0};
+    uint64_t next_quota_report_ns_{0};                           // Next report time (backend thread)
+
+    // Parallel formatting
+    std::atomic<size_t> format_workers_{0};                      // Workers for the next start() (0: inline)
+    std::unique_ptr<FormatPool> format_pool_;                    // Exists while consume_loop() runs with workers
+
+    // Self-profiling (empty unless LOGZ_BACKEND_PROFILING)
+    BackendProfiler profiler_;                                   // TSC cycles per consume_loop stage
+
+    // Shared-memory stats page
+    static constexpr uint64_t STATS_PAGE_INTERVAL_NS = 100000000ull;  // Refresh every 100ms
+    StatsPage stats_page_;                                       // /dev/shm page read by tools/logz_stats
+    std::atomic<bool> stats_page_enabled_{false};                // Publish and time flushes
+    uint64_t next_stats_ns_{0};                                  // Next refresh (backend thread)
+    uint64_t flush_count_{0};                                    // flush_to_disk() calls while enabled
+    uint64_t last_flush_duration_ns_{0};                         // Duration of the last flush
+    uint64_t max_flush_duration_ns_{0};                          // Longest flush
+
+    // Crash-recoverable ring files
+    std::string persistent_dir_;                                 // run_dir/<pid> (empty: heap rings), under m_writer_mutex
+    size_t persistent_queue_count_{0};                           // Queue files created so far
+    CallSiteTable call_site_table_;                              // Decoder -> format / arg types
+    std::atomic<bool> persistent_{false};                        // Flush text when idle
+
+    // Log-to-metrics aggregation
+    MetricsAggregator metrics_;                                  // Counters / histograms per call-site pattern
+    std::atomic<bool> metrics_enabled_{false};                   // Set once a metric is registered
+    uint64_t metrics_interval_ns_{0};                            // Periodic flush interval (0: disabled)
+    uint64_t next_metrics_ns_{0};                                // Next flush time
+
+    // Call-site control file
+    static constexpr uint64_t CONTROL_FILE_CHECK_NS = 1'000'000'000;  // stat() the control file once per second
+    std::string control_file_;                                        // Watched file (empty: disabled)
+    uint64_t control_file_mtime_ns_{0};                               // mtime of the last applied version
+    uint64_t next_control_check_ns_{0};                               // Next stat() time
+
+    // Shared MPSC ring for transient threads
+    static constexpr size_t SHARED_RING_CAPACITY = 1024 * 1024;   // 1MB, created on first use
+    static constexpr uint64_t SHORT_LIVED_QUEUE_NS = 10'000'000;  // Queue lifetimes below this count as short-lived
+    std::unique_ptr<MpscRing> shared_ring_;                        // Owned ring (protected by m_writer_mutex)
+    std::atomic<MpscRing*> shared_ring_ptr_{nullptr};              // Published pointer for lock-free access
+    size_t auto_transient_threshold_{0};                           // 0: automatic mode disabled
+    size_t short_lived_queues_{0};                                 // Short-lived registrations seen so far
+    std::atomic<bool> transient_by_default_{false};                // New threads start on the shared ring
+
+    // Flush barrier (flush_until) and bounded stop
+    std::mutex flush_mutex_;                                     // Guards the fields below and flush_cv_
+    std::condition_variable flush_cv_;                           // Signalled when a barrier completes
+    std::atomic<uint64_t> flush_request_tsc_{0};                 // Highest cutoff requested
+    uint64_t flushed_through_tsc_{0};                            // Highest cutoff completed
+    bool consumer_active_{false};                                // consume_loop() is running
+    std::atomic<int64_t> stop_deadline_ns_{0};                   // steady_clock deadline for the final drain (0: none)
+    bool drained_on_stop_{true};                                 // Last final drain emptied every queue
+
+    // Manual poll mode
+    static constexpr uint64_t FLUSH_INTERVAL_NS = 100'000'000;  // Max time output stays unflushed in poll()
+    static inline std::atomic<bool> s_notify_enabled_{false};    // Producers check this before signalling
+    std::atomic<bool> waiting_{false};                           // Armed by prepare_wait(), cleared by first producer
+    int event_fd_{-1};                                           // eventfd for poll-mode wake-ups
+    uint64_t last_flush_ns_{0};                                  // Last flush time in poll()
 };
 
 } // namespace logZ
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <x86intrin.h>
+
+// Backend self-profiling (TSC accounting per consume_loop stage)
+// 0: compiled out, the hooks are empty (default)
+// 1: Backend::backend_profile() reports cycles per message per stage
+#ifndef LOGZ_BACKEND_PROFILING
+#define LOGZ_BACKEND_PROFILING 0
+#endif
+
+namespace logZ {
+
+/**
+ * @brief Stages of the backend thread
+ */
+enum class ProfileStage : uint8_t {
+    MERGE = 0,     // Scanning queue heads for the oldest entry
+    BUFFER,        // Reading / committing entries, output buffer management, subscribers, metrics
+    TIMESTAMP,     // format_timestamp()
+    DECODE,        // Decoder call (argument decoding + formatting)
+    FLUSH,         // flush_to_disk(): write + fdatasync
+    IDLE,          // Sleeping with no work
+    COUNT
+};
+
+inline constexpr const char* PROFILE_STAGE_NAMES[] = {"merge", "buffer", "timestamp", "decode", "flush", "idle"};
+
+/**
+ * @brief Totals read with Backend::backend_profile()
+ */
+struct BackendProfile {
+    uint64_t cycles[static_cast<size_t>(ProfileStage::COUNT)] = {};  // TSC cycles per stage
+    uint64_t sampled_messages = 0;   // Entries whose per-message stages were timed
+    uint64_t messages = 0;           // All entries processed
+
+    /**
+     * @brief Cycles per message of a per-message stage (MERGE..DECODE)
+     */
+    double cycles_per_message(ProfileStage stage) const {
+        return sampled_messages == 0 ? 0.0
+            : static_cast<double>(cycles[static_cast<size_t>(stage)]) / static_cast<double>(sampled_messages);
+    }
+
+    /**
+     * @brief "merge=120.5 buffer=80.1 timestamp=40.0 decode=310.2 cycles/msg flush=... idle=... cycles"
+     */
+    std::string to_string() const {
+        std::string text;
+        for (size_t i = 0; i <= static_cast<size_t>(ProfileStage::DECODE); ++i) {
+            char value[32];
+            std::snprintf(value, sizeof(value), "%.1f", cycles_per_message(static_cast<ProfileStage>(i)));
+            text += PROFILE_STAGE_NAMES[i];
+            text += "=";
+            text += value;
+            text += " ";
+        }
+        text += "cycles/msg flush=" + std::to_string(cycles[static_cast<size_t>(ProfileStage::FLUSH)]);
+        text += " idle=" + std::to_string(cycles[static_cast<size_t>(ProfileStage::IDLE)]);
+        text += " cycles messages=" + std::to_string(messages);
+        return text;
+    }
+};
+
+/**
+ * @brief TSC accounting on the backend thread
+ *
+ * Per-message stages are timed on one message in SAMPLE_EVERY, with one
+ * RDTSC per stage boundary (lap); the other messages only pay a counter
+ * increment and a branch. Flush and idle are timed every time. All
+ * methods are empty when LOGZ_BACKEND_PROFILING is 0.
+ *
+ * Only the backend thread writes; totals are relaxed atomics so
+ * snapshot() can run on any thread.
+ */
+class BackendProfiler {
+public:
+    static constexpr bool enabled = LOGZ_BACKEND_PROFILING;
+    static constexpr uint32_t SAMPLE_EVERY = 64;  // Power of 2
+
+    /**
+     * @brief Start of a message (decides whether it is sampled)
+     */
+    __attribute__((always_inline))
+    void begin_message() {
+        if constexpr (enabled) {
+            sampling_ = (++counter_ & (SAMPLE_EVERY - 1)) == 0;
+            if (sampling_) {
+                last_tsc_ = __rdtsc();
+            }
+        }
+    }
+
+    /**
+     * @brief Charge the time since the previous boundary to stage (sampled messages only)
+     */
+    __attribute__((always_inline))
+    void lap(ProfileStage stage) {
+        if constexpr (enabled) {
+            if (sampling_) {
+                uint64_t now = __rdtsc();
+                add(stage, now - last_tsc_);
+                last_tsc_ = now;
+            }
+        }
+    }
+
+    /**
+     * @brief End of a message (after its last lap)
+     */
+    __attribute__((always_inline))
+    void end_message() {
+        if constexpr (enabled) {
+            bump(messages_, 1);
+            if (sampling_) {
+                bump(sampled_messages_, 1);
+                sampling_ = false;
+            }
+        }
+    }
+
+    /**
+     * @brief Start timing a non-sampled stage (FLUSH, IDLE)
+     * @return Start TSC (0 when compiled out)
+     */
+    __attribute__((always_inline))
+    uint64_t start() const {
+        if constexpr (enabled) {
+            return __rdtsc();
+        }
+        return 0;
+    }
+
+    __attribute__((always_inline))
+    void stop(ProfileStage stage, uint64_t start_tsc) {
+        if constexpr (enabled) {
+            add(stage, __rdtsc() - start_tsc);
+        }
+    }
+
+    BackendProfile snapshot() const {
+        BackendProfile profile;
+        for (size_t i = 0; i < static_cast<size_t>(ProfileStage::COUNT); ++i) {
+            profile.cycles[i] = cycles_[i].load(std::memory_order_relaxed);
+        }
+        profile.sampled_messages = sampled_messages_.load(std::memory_order_relaxed);
+        profile.messages = messages_.load(std::memory_order_relaxed);
+        return profile;
+    }
+
+    void reset() {
+        for (auto& cycles : cycles_) {
+            cycles.store(0, std::memory_order_relaxed);
+        }
+        sampled_messages_.store(0, std::memory_order_relaxed);
+        messages_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // Single writer: load + store, no read-modify-write
+    static void bump(std::atomic<uint64_t>& value, uint64_t delta) {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    void add(ProfileStage stage, uint64_t cycles) {
+        bump(cycles_[static_cast<size_t>(stage)], cycles);
+    }
+
+    std::atomic<uint64_t> cycles_[static_cast<size_t>(ProfileStage::COUNT)] = {};
+    std::atomic<uint64_t> sampled_messages_{0};
+    std::atomic<uint64_t> messages_{0};
+    uint64_t last_tsc_{0};
+    uint32_t counter_{0};
+    bool sampling_{false};
+};
+
+} // namespace logZ
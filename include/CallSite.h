@@ -0,0 +1,159 @@
+#pragma once
+
+#include "LogTypes.h"
+#include "Fixedstring.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fnmatch.h>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace logZ {
+
+/**
+ * @brief Runtime state of one LOG_xxx call site
+ *
+ * One instance per call site (see CallSiteHolder), constant-initialized and
+ * registered in CallSiteRegistry during dynamic initialization. The LOG_xxx
+ * macro checks `disabled` before doing anything else, so a disabled site
+ * costs one predictable branch: no queue access, no __rdtsc(). Zeroed
+ * storage means enabled, so the check is valid before registration too.
+ */
+struct CallSite {
+    std::atomic<bool> disabled{false}; // Toggled by CallSiteRegistry::set_enabled()
+    std::string_view file;             // Source file (as given by __FILE__)
+    uint32_t line;                     // Source line
+    std::string_view format;           // Format string
+    LogLevel level;                    // Log level of the macro
+
+    constexpr CallSite(std::string_view f, uint32_t l, std::string_view fmt, LogLevel lvl)
+        : file(f), line(l), format(fmt), level(lvl) {}
+
+    CallSite(const CallSite&) = delete;
+    CallSite& operator=(const CallSite&) = delete;
+
+    __attribute__((always_inline))
+    bool is_enabled() const {
+        return !disabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief "filename:line" with the directory stripped (used for pattern matching)
+     */
+    std::string location() const {
+        size_t slash = file.find_last_of("/\\");
+        std::string_view name = (slash == std::string_view::npos) ? file : file.substr(slash + 1);
+        std::string result(name);
+        result += ':';
+        result += std::to_string(line);
+        return result;
+    }
+};
+
+/**
+ * @brief Snapshot of a call site for listing
+ */
+struct CallSiteInfo {
+    std::string location;      // "filename:line"
+    std::string_view format;   // Format string
+    LogLevel level;            // Log level
+    bool enabled;              // Current state
+};
+
+/**
+ * @brief Process-wide list of all LOG_xxx call sites
+ */
+class CallSiteRegistry {
+public:
+    static CallSiteRegistry& instance() {
+        static CallSiteRegistry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Register a call site (dynamic-initialization time, see CallSiteHolder)
+     */
+    void add(CallSite* site) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sites_.push_back(site);
+    }
+
+    /**
+     * @brief Enable or disable all call sites matching a pattern
+     * @param pattern Shell glob (fnmatch) matched against "filename:line"
+     *                and against the format string, e.g. "Order*.cpp:*"
+     *                or "*heartbeat*"
+     * @param enabled New state
+     * @return Number of matching call sites
+     */
+    size_t set_enabled(const std::string& pattern, bool enabled) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t matched = 0;
+        for (CallSite* site : sites_) {
+            std::string format(site->format);
+            if (::fnmatch(pattern.c_str(), site->location().c_str(), 0) == 0 ||
+                ::fnmatch(pattern.c_str(), format.c_str(), 0) == 0) {
+                site->disabled.store(!enabled, std::memory_order_relaxed);
+                ++matched;
+            }
+        }
+        return matched;
+    }
+
+    /**
+     * @brief List all registered call sites
+     */
+    std::vector<CallSiteInfo> list() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<CallSiteInfo> result;
+        result.reserve(sites_.size());
+        for (const CallSite* site : sites_) {
+            result.push_back(CallSiteInfo{site->location(), site->format, site->level, site->is_enabled()});
+        }
+        return result;
+    }
+
+private:
+    CallSiteRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<CallSite*> sites_;
+};
+
+/**
+ * @brief Adds one call site to the registry
+ */
+struct CallSiteRegistrar {
+    explicit CallSiteRegistrar(CallSite& site) {
+        CallSiteRegistry::instance().add(&site);
+    }
+};
+
+/**
+ * @brief Owns the CallSite of one LOG_xxx expansion
+ * The site is constinit, so its switch is usable from program start (even
+ * from another translation unit's static initializer) and reading it needs
+ * no initialization guard. Registration is a separate, dynamically
+ * initialized member that get() instantiates: every call site is listed
+ * before main() even if it never runs.
+ */
+template<auto File, uint32_t Line, auto Fmt, LogLevel Level>
+struct CallSiteHolder {
+    static constinit inline CallSite site{File.sv(), Line, Fmt.sv(), Level};
+    static inline CallSiteRegistrar registrar{site};
+
+    __attribute__((always_inline))
+    static CallSite& get() {
+        (void)&registrar;  // Odr-use: instantiates the registration
+        return site;
+    }
+};
+
+} // namespace logZ
+
+// Call site of the current macro expansion
+#define LOGZ_CALL_SITE(level, fmt) \
+    ::logZ::CallSiteHolder<::logZ::FixedString(__FILE__), __LINE__, ::logZ::FixedString(fmt), level>::get()
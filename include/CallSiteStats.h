@@ -0,0 +1,120 @@
+#pragma once
+
+#include "LogTypes.h"
+#include "Decoder.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace logZ {
+
+/**
+ * @brief Per-call-site volume counters, one row per decoder
+ *
+ * A decoder is generated per format string + argument types, so it identifies
+ * a LOG_xxx call site (sites sharing both are counted together).
+ */
+struct CallSiteStat {
+    DecoderFunc decoder;        // Key (Metadata::decoder)
+    std::string_view format;    // Format string from DecoderRegistry
+    uint64_t count;             // Messages processed
+    uint64_t encoded_bytes;     // Bytes in producer queues (Metadata + args)
+    uint64_t formatted_bytes;   // Bytes of formatted output
+};
+
+/**
+ * @brief Call-site statistics collected by the Backend
+ *
+ * Only the backend thread records, and only it inserts rows, so it looks a
+ * row up without the mutex; the mutex orders an insertion against readers
+ * iterating the map. Counters are per-row atomics, so recording an existing
+ * call site takes no lock. Producers are never involved.
+ */
+class CallSiteStats {
+public:
+    /**
+     * @brief Account one processed message (backend thread)
+     */
+    void record(DecoderFunc decoder, size_t encoded_bytes, size_t formatted_bytes) {
+        auto it = counters_.find(decoder);
+        if (it == counters_.end()) [[unlikely]] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            it = counters_.try_emplace(decoder).first;
+        }
+        Counters& counters = it->second;
+        counters.count.fetch_add(1, std::memory_order_relaxed);
+        counters.encoded_bytes.fetch_add(encoded_bytes, std::memory_order_relaxed);
+        counters.formatted_bytes.fetch_add(formatted_bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the K call sites with the most formatted bytes
+     * @param k Maximum number of rows (0 returns all)
+     * @return Rows sorted by formatted bytes, then message count
+     */
+    std::vector<CallSiteStat> top(size_t k) const {
+        std::vector<CallSiteStat> rows;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rows.reserve(counters_.size());
+            for (const auto& [decoder, counters] : counters_) {
+                uint64_t count = counters.count.load(std::memory_order_relaxed);
+                if (count == 0) {
+                    continue;  // Not seen since reset()
+                }
+                rows.push_back(CallSiteStat{decoder, {}, count,
+                                            counters.encoded_bytes.load(std::memory_order_relaxed),
+                                            counters.formatted_bytes.load(std::memory_order_relaxed)});
+            }
+        }
+
+        auto by_volume = [](const CallSiteStat& a, const CallSiteStat& b) {
+            if (a.formatted_bytes != b.formatted_bytes) {
+                return a.formatted_bytes > b.formatted_bytes;
+            }
+            return a.count > b.count;
+        };
+        if (k > 0 && k < rows.size()) {
+            std::partial_sort(rows.begin(), rows.begin() + k, rows.end(), by_volume);
+            rows.resize(k);
+        } else {
+            std::sort(rows.begin(), rows.end(), by_volume);
+        }
+
+        // Resolve names only for the rows returned
+        for (auto& row : rows) {
+            row.format = DecoderRegistry::instance().find(row.decoder).format;
+        }
+        return rows;
+    }
+
+    /**
+     * @brief Zero all counters
+     * Rows stay allocated (the backend looks them up without the mutex)
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [decoder, counters] : counters_) {
+            counters.count.store(0, std::memory_order_relaxed);
+            counters.encoded_bytes.store(0, std::memory_order_relaxed);
+            counters.formatted_bytes.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> encoded_bytes{0};
+        std::atomic<uint64_t> formatted_bytes{0};
+    };
+
+    mutable std::mutex mutex_;                               // Insertions vs. readers
+    std::unordered_map<DecoderFunc, Counters> counters_;     // Inserted by the backend thread only
+};
+
+} // namespace logZ
@@ -2,8 +2,13 @@
 #include "LogTypes.h"
 #include "StringRingBuffer.h"
 #include "Fixedstring.h"
+#include "StackTrace.h"
+#include "ErrorText.h"
+#include "EnumNames.h"
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <type_traits>
 #include <tuple>
@@ -11,6 +16,9 @@
 #include <format>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <mutex>
+#include <unordered_map>
 
 
 namespace logZ {
@@ -28,6 +36,26 @@ namespace logZ {
  */
 
 
+template<typename T>
+struct is_chrono_duration : std::false_type {};
+
+template<typename Rep, typename Period>
+struct is_chrono_duration<std::chrono::duration<Rep, Period>> : std::true_type {};
+
+template<typename T>
+struct is_chrono_time_point : std::false_type {};
+
+template<typename Clock, typename Duration>
+struct is_chrono_time_point<std::chrono::time_point<Clock, Duration>> : std::true_type {};
+
+// Time point without calendar meaning (steady_clock, ...)
+template<typename T>
+struct is_non_system_time_point : std::false_type {};
+
+template<typename Clock, typename Duration>
+struct is_non_system_time_point<std::chrono::time_point<Clock, Duration>>
+    : std::bool_constant<!std::is_same_v<Clock, std::chrono::system_clock>> {};
+
 /**
  * @brief Helper to decode and extract value from a single argument
  * @tparam T Type to decode
@@ -39,8 +67,18 @@ struct DecodedValue {
     using RawT = std::remove_cv_t<std::remove_reference_t<T>>;
     
     static auto decode_impl(const std::byte* ptr) {
+        // Case 1a: Enums - underlying integer encoded, name from the compile-time table
+        if constexpr (std::is_enum_v<RawT> && enable_enum_names<RawT>) {
+            RawT value;
+            std::memcpy(&value, ptr, sizeof(RawT));
+            std::string_view name = enum_name(value);
+            std::string text = name.empty()
+                ? std::to_string(static_cast<std::underlying_type_t<RawT>>(value))
+                : std::string(name);
+            return std::make_pair(std::move(text), ptr + sizeof(RawT));
+        }
         // Case 1: Arithmetic types (int, double, enum, etc.) - direct memory read
-        if constexpr (std::is_arithmetic_v<RawT> || std::is_enum_v<RawT>) {
+        else if constexpr (std::is_arithmetic_v<RawT> || std::is_enum_v<RawT>) {
             RawT value;
             std::memcpy(&value, ptr, sizeof(RawT));
             return std::make_pair(value, ptr + sizeof(RawT));
@@ -74,7 +112,36 @@ struct DecodedValue {
             const char* str = reinterpret_cast<const char*>(ptr);
             return std::make_pair(std::string_view(str, len), ptr + len);
         }
+        // Case 4: Stack traces - symbolized here, on the backend thread (cached)
+        else if constexpr (std::is_same_v<RawT, StackTrace>) {
+            uint16_t depth = 0;
+            std::memcpy(&depth, ptr, sizeof(uint16_t));
+            ptr += sizeof(uint16_t);
+            
+            void* frames[LOGZ_STACKTRACE_DEPTH];
+            std::memcpy(frames, ptr, depth * sizeof(void*));
+            return std::make_pair(Symbolizer::instance().format(frames, depth), ptr + depth * sizeof(void*));
+        }
+        // Case 5: errno / std::error_code - raw value encoded, text rendered here (cached)
+        else if constexpr (std::is_same_v<RawT, ErrnoValue>) {
+            ErrnoValue value;
+            std::memcpy(&value, ptr, sizeof(ErrnoValue));
+            return std::make_pair(ErrorTextCache::instance().errno_text(value.code), ptr + sizeof(ErrnoValue));
+        }
+        else if constexpr (std::is_same_v<RawT, std::error_code>) {
+            std::error_code value;
+            std::memcpy(static_cast<void*>(&value), ptr, sizeof(std::error_code));
+            return std::make_pair(ErrorTextCache::instance().error_code_text(value), ptr + sizeof(std::error_code));
+        }
+        // Case 6: time points of clocks other than system_clock (steady_clock, ...) have
+        // no calendar meaning: formatted as the duration since the clock's epoch
+        else if constexpr (is_non_system_time_point<RawT>::value) {
+            RawT value;
+            std::memcpy(static_cast<void*>(&value), ptr, sizeof(RawT));
+            return std::make_pair(value.time_since_epoch(), ptr + sizeof(RawT));
+        }
         // Default case for other types
+        // (includes std::chrono durations and system_clock time points: raw ticks)
         else {
             RawT value;
             std::memcpy(&value, ptr, sizeof(RawT));
@@ -128,6 +195,349 @@ void decode(const std::byte* ptr, StringRingBuffer::StringWriter& writer) {
     }
 }
 
+/**
+ * @brief One encoded argument read back with its type, without formatting
+ */
+struct ArgValue {
+    enum class Type : uint8_t { NONE, INT, UINT, DOUBLE, STRING };
+
+    Type type{Type::NONE};
+    int64_t i{0};              // Type::INT (signed integers, enums, bool, char)
+    uint64_t u{0};             // Type::UINT
+    double d{0.0};             // Type::DOUBLE
+    std::string_view str;      // Type::STRING (points into the queue entry); for an errno or
+                               // std::error_code (Type::INT, the code) its cached rendered text
+
+    /**
+     * @brief Numeric value as double (0 for strings)
+     */
+    double as_double() const {
+        switch (type) {
+            case Type::INT:    return static_cast<double>(i);
+            case Type::UINT:   return static_cast<double>(u);
+            case Type::DOUBLE: return d;
+            default:           return 0.0;
+        }
+    }
+};
+
+/**
+ * @brief Reads the encoded arguments of one decoder into ArgValues
+ * @return Number of values written (at most max)
+ */
+using ArgExtractor = size_t (*)(const std::byte* ptr, ArgValue* out, size_t max);
+
+/**
+ * @brief Convert a decoded value to ArgValue
+ */
+template<typename T>
+ArgValue to_arg_value(const T& value) {
+    ArgValue result;
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        result.type = ArgValue::Type::STRING;
+        result.str = value;
+    } else if constexpr (is_chrono_duration<T>::value) {
+        result.type = ArgValue::Type::INT;
+        result.i = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(value).count());
+    } else if constexpr (is_chrono_time_point<T>::value) {
+        result.type = ArgValue::Type::INT;
+        result.i = static_cast<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(value.time_since_epoch()).count());
+    } else if constexpr (std::is_enum_v<T>) {
+        result.type = ArgValue::Type::INT;
+        result.i = static_cast<int64_t>(value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        result.type = ArgValue::Type::DOUBLE;
+        result.d = static_cast<double>(value);
+    } else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>) {
+        result.type = ArgValue::Type::UINT;
+        result.u = static_cast<uint64_t>(value);
+    } else if constexpr (std::is_integral_v<T>) {
+        result.type = ArgValue::Type::INT;
+        result.i = static_cast<int64_t>(value);
+    }
+    return result;
+}
+
+/**
+ * @brief ArgExtractor for one Args... combination (generated next to decode<>)
+ */
+template<typename... Args>
+size_t extract_args(const std::byte* ptr, ArgValue* out, size_t max) {
+    if constexpr (sizeof...(Args) == 0) {
+        return 0;
+    } else {
+        size_t count = 0;
+        const std::byte* current = ptr;
+        auto extract_one = [&]<typename T>() {
+            if (count >= max) {
+                return;
+            }
+            using RawT = std::remove_cv_t<std::remove_reference_t<T>>;
+            if constexpr (std::is_enum_v<RawT>) {
+                // Integer value, not the rendered name
+                RawT value;
+                std::memcpy(&value, current, sizeof(RawT));
+                current += sizeof(RawT);
+                out[count++] = to_arg_value(value);
+            } else if constexpr (std::is_same_v<RawT, ErrnoValue>) {
+                // Integer code, text alongside
+                ErrnoValue value;
+                std::memcpy(&value, current, sizeof(ErrnoValue));
+                current += sizeof(ErrnoValue);
+                ArgValue& arg = out[count++];
+                arg = to_arg_value(value.code);
+                arg.str = ErrorTextCache::instance().errno_text(value.code);
+            } else if constexpr (std::is_same_v<RawT, std::error_code>) {
+                std::error_code value;
+                std::memcpy(static_cast<void*>(&value), current, sizeof(std::error_code));
+                current += sizeof(std::error_code);
+                ArgValue& arg = out[count++];
+                arg = to_arg_value(value.value());
+                arg.str = ErrorTextCache::instance().error_code_text(value);
+            } else if constexpr (std::is_same_v<RawT, StackTrace>) {
+                // Skipped (Type::NONE): symbolizing is left to text rendering
+                uint16_t depth = 0;
+                std::memcpy(&depth, current, sizeof(uint16_t));
+                current += sizeof(uint16_t) + depth * sizeof(void*);
+                out[count++] = ArgValue{};
+            } else {
+                auto pair = DecodedValue<T>::decode_impl(current);
+                current = pair.second;
+                out[count++] = to_arg_value(pair.first);
+            }
+        };
+        (extract_one.template operator()<Args>(), ...);
+        return count;
+    }
+}
+
+/**
+ * @brief Start/end TSC pair of a LOG_SCOPE_TIMER entry
+ * Encoded as the first argument; selects decode_timed() (see DecoderFor)
+ */
+struct ScopeTiming {
+    uint64_t start_tsc;
+    uint64_t end_tsc;
+
+    /**
+     * @brief Duration converted with TscCalibration
+     */
+    uint64_t duration_ns() const {
+        uint64_t ticks = end_tsc > start_tsc ? end_tsc - start_tsc : 0;
+        return static_cast<uint64_t>(static_cast<double>(ticks) * TscCalibration::instance().tsc_to_ns_ratio);
+    }
+};
+
+/**
+ * @brief Append a duration as "took 1.234ms" (ns / us / ms / s)
+ */
+inline void append_duration(StringRingBuffer::StringWriter& writer, uint64_t ns) {
+    static constexpr const char* units[] = {"ns", "us", "ms", "s"};
+    size_t unit = 0;
+    uint64_t divisor = 1;
+    while (unit < 3 && ns >= divisor * 1000) {
+        divisor *= 1000;
+        ++unit;
+    }
+
+    writer.append(" took ");
+    writer.append(std::to_string(ns / divisor));
+    if (unit > 0) {
+        // Three decimals, from integer math
+        uint64_t frac = (ns % divisor) / (divisor / 1000);
+        char digits[5] = {'.', static_cast<char>('0' + frac / 100), static_cast<char>('0' + frac / 10 % 10),
+                          static_cast<char>('0' + frac % 10), '\0'};
+        writer.append(std::string_view(digits, 4));
+    }
+    writer.append(units[unit]);
+}
+
+/**
+ * @brief Decoder of a LOG_SCOPE_TIMER entry: the message, then its duration
+ */
+template<auto FMT, typename... Args>
+void decode_timed(const std::byte* ptr, StringRingBuffer::StringWriter& writer) {
+    ScopeTiming timing;
+    std::memcpy(&timing, ptr, sizeof(ScopeTiming));
+    decode<FMT, Args...>(ptr + sizeof(ScopeTiming), writer);
+    append_duration(writer, timing.duration_ns());
+}
+
+/**
+ * @brief ArgExtractor of a LOG_SCOPE_TIMER entry
+ * The user arguments, followed by the duration in ns (Type::UINT) as last value.
+ * The last slot is reserved for the duration: at most max - 1 user arguments.
+ */
+template<typename... Args>
+size_t extract_timed_args(const std::byte* ptr, ArgValue* out, size_t max) {
+    if (max == 0) {
+        return 0;
+    }
+    ScopeTiming timing;
+    std::memcpy(&timing, ptr, sizeof(ScopeTiming));
+    size_t count = extract_args<Args...>(ptr + sizeof(ScopeTiming), out, max - 1);
+    out[count++] = to_arg_value(timing.duration_ns());
+    return count;
+}
+
+/**
+ * @brief Decoder and extractor for one FMT + Args... combination
+ */
+template<auto FMT, typename... Args>
+struct DecoderFor {
+    static constexpr auto decoder = &decode<FMT, Args...>;
+    static constexpr ArgExtractor extract = &extract_args<Args...>;
+};
+
+template<auto FMT, typename... Args>
+struct DecoderFor<FMT, ScopeTiming, Args...> {
+    static constexpr auto decoder = &decode_timed<FMT, Args...>;
+    static constexpr ArgExtractor extract = &extract_timed_args<Args...>;
+};
+
+/**
+ * @brief Wire type of one encoded argument, for decoding outside the process
+ * 
+ * Tokens: b (bool), c (char), i<N>/u<N> (signed/unsigned integer or enum of
+ * N bytes), f<N> (float/double), s (runtime string), L (literal: length +
+ * pointer), T (stack trace), n (errno), t (ScopeTiming), x<N> (other N bytes)
+ */
+template<typename T>
+std::string arg_type_token() {
+    using RawT = std::remove_cv_t<std::remove_reference_t<T>>;
+    if constexpr (std::is_same_v<RawT, bool>) {
+        return "b";
+    } else if constexpr (std::is_same_v<RawT, char>) {
+        return "c";
+    } else if constexpr (std::is_enum_v<RawT>) {
+        return arg_type_token<std::underlying_type_t<RawT>>();
+    } else if constexpr (std::is_integral_v<RawT>) {
+        return (std::is_signed_v<RawT> ? "i" : "u") + std::to_string(sizeof(RawT));
+    } else if constexpr (std::is_same_v<RawT, float> || std::is_same_v<RawT, double>) {
+        return "f" + std::to_string(sizeof(RawT));
+    } else if constexpr (is_fixed_string_v<RawT>) {
+        return "L";
+    } else if constexpr (
+        (std::is_array_v<RawT> && std::is_same_v<std::remove_extent_t<RawT>, char>) ||
+        std::is_same_v<RawT, std::string> ||
+        std::is_same_v<RawT, std::string_view> ||
+        (std::is_pointer_v<RawT> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<RawT>>, char>)
+    ) {
+        return "s";
+    } else if constexpr (std::is_same_v<RawT, StackTrace>) {
+        return "T";
+    } else if constexpr (std::is_same_v<RawT, ErrnoValue>) {
+        return "n";
+    } else if constexpr (std::is_same_v<RawT, ScopeTiming>) {
+        return "t";
+    } else {
+        return "x" + std::to_string(sizeof(RawT));
+    }
+}
+
+/**
+ * @brief Space-separated arg_type_token()s of Args... (built once, on first use)
+ */
+template<typename... Args>
+std::string_view arg_type_signature() {
+    static const std::string signature = [] {
+        std::string result;
+        ((result += arg_type_token<Args>(), result += ' '), ...);
+        if (!result.empty()) {
+            result.pop_back();
+        }
+        return result;
+    }();
+    return signature;
+}
+
+/**
+ * @brief Static description of a decoder (one per FMT + Args... combination)
+ */
+struct DecoderInfo {
+    DecoderFunc decoder;       // Decoder as stored in Metadata
+    std::string_view format;   // Format string (points into the FixedString template argument)
+    ArgExtractor extract{nullptr};  // Typed access to the encoded arguments
+    std::string_view arg_types;     // arg_type_signature() of the encoded arguments
+};
+
+/**
+ * @brief Process-wide map from decoder pointer to its DecoderInfo
+ * 
+ * Populated at static-initialization time (see decoder_registered), so the
+ * hot path never touches it. The Backend uses it to name call sites.
+ */
+class DecoderRegistry {
+public:
+    static DecoderRegistry& instance() {
+        static DecoderRegistry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Register a decoder (static-init time or dlopen)
+     * @return Always true (used as initializer of decoder_registered)
+     */
+    bool add(const DecoderInfo& info) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (decoders_.emplace(info.decoder, info).second && listener_ != nullptr) {
+            listener_(info, listener_context_);
+        }
+        return true;
+    }
+
+    using Listener = void (*)(const DecoderInfo& info, void* context);
+
+    /**
+     * @brief Call listener for every registered decoder, now and on later add()s
+     * (used to keep the crash-recovery call-site table complete); nullptr removes it
+     */
+    void set_listener(Listener listener, void* context) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        listener_ = listener;
+        listener_context_ = context;
+        if (listener_ != nullptr) {
+            for (const auto& [decoder, info] : decoders_) {
+                listener_(info, listener_context_);
+            }
+        }
+    }
+
+    /**
+     * @brief Look up a decoder
+     * @return DecoderInfo copy, or an info with empty format if unknown
+     */
+    DecoderInfo find(DecoderFunc decoder) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = decoders_.find(decoder);
+        if (it == decoders_.end()) {
+            return DecoderInfo{decoder, {}, nullptr, {}};
+        }
+        return it->second;
+    }
+
+private:
+    DecoderRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<DecoderFunc, DecoderInfo> decoders_;
+    Listener listener_{nullptr};
+    void* listener_context_{nullptr};
+};
+
+/**
+ * @brief Registers the decoder of FMT + Args... during static initialization
+ * Instantiated by get_decoder(), i.e. once per LOG_xxx format/argument combination
+ */
+template<auto FMT, typename... Args>
+inline const bool decoder_registered = DecoderRegistry::instance().add(DecoderInfo{
+    reinterpret_cast<DecoderFunc>(DecoderFor<FMT, Args...>::decoder),
+    FMT.sv(),
+    DecoderFor<FMT, Args...>::extract,
+    arg_type_signature<Args...>()
+});
+
 /**
  * @brief Generate decoder function for specific argument types
  * @tparam FMT Format string as non-type template parameter
@@ -136,9 +546,12 @@ void decode(const std::byte* ptr, StringRingBuffer::StringWriter& writer) {
  */
 template<auto FMT, typename... Args>
 auto get_decoder() {
+    // Taking the address instantiates the registration (no runtime cost here)
+    (void)&decoder_registered<FMT, Args...>;
+    
     // Return a static function pointer for this specific argument type combination
     // This function is generated at compile-time, one per unique Args... combination
-    return &decode<FMT, Args...>;
+    return DecoderFor<FMT, Args...>::decoder;
 }
 
 } // namespace logZ
@@ -3,15 +3,53 @@
 #include "LogTypes.h"
 #include "Decoder.h"
 #include "Fixedstring.h"
+#include "StackTrace.h"
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <type_traits>
 #include <string>
 #include <string_view>
+#include <emmintrin.h>
+
+// Streaming copy of runtime string arguments
+// 0: plain memcpy (default)
+// N: strings of N bytes or more are written with non-temporal stores, so
+//    payload only the backend reads does not evict the producer's working
+//    set from L1/L2. Worth it from a few hundred bytes; below that the
+//    partial head/tail lines and the sfence cost more than they save.
+#ifndef LOGZ_NT_STORE_THRESHOLD
+#define LOGZ_NT_STORE_THRESHOLD 0
+#endif
 
 namespace logZ {
 
+namespace detail {
+
+/**
+ * @brief memcpy with non-temporal stores for the 16-byte aligned middle
+ *
+ * Unaligned head and tail bytes use normal stores. Ends with sfence: NT
+ * stores are weakly ordered and would otherwise not be covered by the
+ * release store of commit_write().
+ */
+inline void stream_copy(std::byte* dst, const char* src, size_t len) {
+    size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+    if (head > len) {
+        head = len;
+    }
+    std::memcpy(dst, src, head);
+    size_t i = head;
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), chunk);
+    }
+    std::memcpy(dst + i, src + i, len - i);
+    _mm_sfence();
+}
+
+} // namespace detail
+
 template<typename T>
 __attribute__((always_inline))
 inline size_t calculate_single_arg_size(const T& arg) {
@@ -47,6 +85,10 @@ inline size_t calculate_single_arg_size(const T& arg) {
         }
         return sizeof(unsigned short) + len;
     }
+    // Case 4: Stack traces - depth (2 bytes) + captured frames only
+    else if constexpr (std::is_same_v<RawT, StackTrace>) {
+        return sizeof(uint16_t) + arg.depth * sizeof(void*);
+    }
     // Default case for other types
     else {
         return sizeof(RawT);
@@ -129,10 +171,26 @@ inline std::byte* encode_single_arg(std::byte* ptr, const T& arg) {
         unsigned short len = static_cast<unsigned short>(str_len);
         std::memcpy(ptr, &len, sizeof(unsigned short));
         ptr += sizeof(unsigned short);
+        if constexpr (LOGZ_NT_STORE_THRESHOLD > 0) {
+            if (len >= LOGZ_NT_STORE_THRESHOLD) [[unlikely]] {
+                detail::stream_copy(ptr, str_data, len);
+                return ptr + len;
+            }
+        }
         std::memcpy(ptr, str_data, len);
         return ptr + len;
     }
+    // Case 4: Stack traces - depth (2 bytes) + captured frames only
+    else if constexpr (std::is_same_v<RawT, StackTrace>) {
+        std::memcpy(ptr, &arg.depth, sizeof(uint16_t));
+        ptr += sizeof(uint16_t);
+        std::memcpy(ptr, arg.frames, arg.depth * sizeof(void*));
+        return ptr + arg.depth * sizeof(void*);
+    }
     // Default case for other types
+    // ErrnoValue, std::error_code and std::chrono durations / time points are
+    // trivially copyable: only the raw value or ticks are stored, the text is
+    // produced by the backend
     else {
         std::memcpy(ptr, &arg, sizeof(RawT));
         return ptr + sizeof(RawT);
@@ -158,13 +216,14 @@ inline void encode_args(std::byte* buffer, const Args&... args) {
  * @brief Encode log metadata and arguments into buffer
  * @tparam FMT Format string (compile-time constant)
  * @tparam Level Log level (compile-time constant)
+ * @tparam Kind Entry kind
  * @tparam Args Types of arguments to encode
  * @param buffer Buffer to write to
  * @param timestamp Timestamp in nanoseconds
  * @param args_size Size of arguments (pre-calculated to avoid redundant computation)
  * @param args Arguments to encode
  */
-template<auto FMT, LogLevel Level, typename... Args>
+template<auto FMT, LogLevel Level, EntryKind Kind = EntryKind::LOG, typename... Args>
 __attribute__((always_inline))
 inline void encode_log_entry(std::byte* buffer, uint64_t timestamp, size_t args_size, const Args&... args) {
     // Use Metadata from LogTypes.h (optimized layout)
@@ -173,10 +232,30 @@ inline void encode_log_entry(std::byte* buffer, uint64_t timestamp, size_t args_
     metadata->decoder = reinterpret_cast<DecoderFunc>(get_decoder<FMT, Args...>());
     metadata->args_size = static_cast<uint32_t>(args_size);
     metadata->level = Level;
+    metadata->kind = Kind;
+    metadata->dropped_before = 0;
     
     // Write arguments after metadata
     std::byte* ptr = buffer + sizeof(Metadata);
     encode_args(ptr, args...);
 }
 
+/**
+ * @brief Encode a thread-context change record (see ScopedContext)
+ * @param buffer Buffer of sizeof(Metadata) + calculate_single_arg_size(context) bytes
+ * @param timestamp TSC value
+ * @param context Rendered context prefix (empty: context cleared)
+ */
+__attribute__((always_inline))
+inline void encode_context_entry(std::byte* buffer, uint64_t timestamp, std::string_view context) {
+    Metadata* metadata = reinterpret_cast<Metadata*>(buffer);
+    metadata->timestamp = timestamp;
+    metadata->decoder = nullptr;
+    metadata->args_size = static_cast<uint32_t>(calculate_single_arg_size(context));
+    metadata->level = LogLevel::TRACE;
+    metadata->kind = EntryKind::CONTEXT;
+    metadata->dropped_before = 0;
+    encode_single_arg(buffer + sizeof(Metadata), context);
+}
+
 } // namespace logZ
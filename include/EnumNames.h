@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Default enumerator values covered by the compile-time name table (see
+// enum_range to narrow it per enum; values outside are printed as integers)
+#ifndef LOGZ_ENUM_RANGE_MIN
+#define LOGZ_ENUM_RANGE_MIN -128
+#endif
+#ifndef LOGZ_ENUM_RANGE_MAX
+#define LOGZ_ENUM_RANGE_MAX 127
+#endif
+
+namespace logZ {
+
+/**
+ * @brief Opt-out for enums that have their own formatter
+ * template<> inline constexpr bool enable_enum_names<MyEnum> = false;
+ */
+template<typename E>
+inline constexpr bool enable_enum_names = true;
+
+/**
+ * @brief Values scanned for names of E (clamped to the underlying type)
+ * Each value instantiates one template: narrow it for large enums or builds
+ *   template<> struct logZ::enum_range<MyEnum> { static constexpr long long min = 0, max = 15; };
+ */
+template<typename E>
+struct enum_range {
+    static constexpr long long min = LOGZ_ENUM_RANGE_MIN;
+    static constexpr long long max = LOGZ_ENUM_RANGE_MAX;
+};
+
+/**
+ * @brief Enum with a fixed underlying type (scoped, or unscoped with ": T")
+ * Only these can hold every value of the underlying type: for the others,
+ * static_cast of a value outside the enumerators' range is undefined, so
+ * they are printed as integers.
+ */
+template<typename E>
+concept fixed_underlying_enum = std::is_enum_v<E> && requires { E{std::underlying_type_t<E>{}}; };
+
+/**
+ * @brief Name of enumerator V, or empty if V is not a named enumerator
+ * 
+ * Parsed from __PRETTY_FUNCTION__ at compile time:
+ *   "... [with auto V = Color::Red; ...]"  -> "Red"
+ *   "... [with auto V = (Color)5; ...]"    -> ""  (no enumerator with that value)
+ */
+template<auto V>
+constexpr std::string_view enum_value_name() {
+    std::string_view function = __PRETTY_FUNCTION__;
+    size_t start = function.find("V = ");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    start += 4;
+    size_t end = function.find_first_of(";]", start);
+    std::string_view name = function.substr(start, end - start);
+    if (name.empty() || name[0] == '(' || name[0] == '-' || (name[0] >= '0' && name[0] <= '9')) {
+        return {};
+    }
+    size_t scope = name.rfind("::");
+    return scope == std::string_view::npos ? name : name.substr(scope + 2);
+}
+
+/**
+ * @brief Compile-time table of enumerator names for E
+ * Covers enum_range<E> intersected with the underlying type's values;
+ * built once per enum type, nothing runs at startup.
+ */
+template<fixed_underlying_enum E>
+struct EnumNames {
+    using Underlying = std::underlying_type_t<E>;
+
+    static constexpr long long TYPE_MIN = std::is_signed_v<Underlying>
+        ? static_cast<long long>(std::numeric_limits<Underlying>::min()) : 0;
+    static constexpr long long TYPE_MAX = std::numeric_limits<Underlying>::max() > std::numeric_limits<long long>::max()
+        ? std::numeric_limits<long long>::max() : static_cast<long long>(std::numeric_limits<Underlying>::max());
+
+    static constexpr long long MIN = enum_range<E>::min > TYPE_MIN ? enum_range<E>::min : TYPE_MIN;
+    static constexpr long long MAX = enum_range<E>::max < TYPE_MAX ? enum_range<E>::max : TYPE_MAX;
+    static_assert(MIN <= MAX, "enum_range does not intersect the underlying type");
+    static constexpr size_t SIZE = static_cast<size_t>(MAX - MIN + 1);
+
+    template<size_t... I>
+    static constexpr std::array<std::string_view, SIZE> build(std::index_sequence<I...>) {
+        return {enum_value_name<static_cast<E>(MIN + static_cast<long long>(I))>()...};
+    }
+
+    static constexpr std::array<std::string_view, SIZE> names = build(std::make_index_sequence<SIZE>{});
+
+    /**
+     * @brief Name of value, or empty if unnamed / out of range
+     */
+    static constexpr std::string_view name(E value) {
+        long long index = static_cast<long long>(static_cast<Underlying>(value)) - MIN;
+        if (index < 0 || index >= static_cast<long long>(SIZE)) {
+            return {};
+        }
+        return names[static_cast<size_t>(index)];
+    }
+};
+
+/**
+ * @brief Name of an enum value (empty if not a named enumerator in range,
+ * or if E has no fixed underlying type)
+ */
+template<typename E>
+constexpr std::string_view enum_name(E value) {
+    if constexpr (fixed_underlying_enum<E>) {
+        return EnumNames<E>::name(value);
+    } else {
+        return {};
+    }
+}
+
+} // namespace logZ
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+namespace logZ {
+
+/**
+ * @brief errno value logged as an integer, rendered as text by the backend
+ * Usage: LOG_ERROR("open {} failed: {}", path, logZ::errno_val());
+ */
+struct ErrnoValue {
+    int code;
+};
+
+/**
+ * @brief Capture errno (or an explicit code) without formatting it
+ */
+__attribute__((always_inline))
+inline ErrnoValue errno_val(int code = errno) {
+    return ErrnoValue{code};
+}
+
+/**
+ * @brief Cached error texts for ErrnoValue and std::error_code arguments
+ * 
+ * Each code is rendered once (strerror_r / error_category::message) and the
+ * string_view handed to the formatter stays valid for the process lifetime.
+ */
+class ErrorTextCache {
+public:
+    static ErrorTextCache& instance() {
+        static ErrorTextCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief "No such file or directory (2)"
+     */
+    std::string_view errno_text(int code) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = errno_texts_.find(code);
+        if (it == errno_texts_.end()) {
+            char buffer[256];
+            std::string text = strerror_text(::strerror_r(code, buffer, sizeof(buffer)), buffer);
+            text += " (";
+            text += std::to_string(code);
+            text += ")";
+            it = errno_texts_.emplace(code, std::move(text)).first;
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief "No such file or directory (generic:2)"
+     */
+    std::string_view error_code_text(const std::error_code& ec) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto key = std::make_pair(&ec.category(), ec.value());
+        auto it = error_code_texts_.find(key);
+        if (it == error_code_texts_.end()) {
+            std::string text = ec.message();
+            text += " (";
+            text += ec.category().name();
+            text += ":";
+            text += std::to_string(ec.value());
+            text += ")";
+            it = error_code_texts_.emplace(key, std::move(text)).first;
+        }
+        return it->second;
+    }
+
+private:
+    ErrorTextCache() = default;
+
+    // GNU strerror_r returns the message, XSI strerror_r fills the buffer
+    static std::string strerror_text(const char* message, const char*) {
+        return message;
+    }
+    static std::string strerror_text(int result, const char* buffer) {
+        return result == 0 ? buffer : "Unknown error";
+    }
+
+    struct PairHash {
+        size_t operator()(const std::pair<const std::error_category*, int>& key) const {
+            return std::hash<const void*>()(key.first) ^ std::hash<int>()(key.second);
+        }
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<int, std::string> errno_texts_;
+    std::unordered_map<std::pair<const std::error_category*, int>, std::string, PairHash> error_code_texts_;
+};
+
+} // namespace logZ
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "LogTypes.h"
+#include "StringRingBuffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace logZ {
+
+/**
+ * @brief Header of one record in FormatChunk::input (8-byte aligned)
+ * entry_size > 0: encoded entry (Metadata + args) followed by the context prefix
+ * entry_size == 0: text written as is (drop markers)
+ */
+struct FormatRecord {
+    uint32_t entry_size;
+    uint32_t extra_size;   // Context prefix or text bytes
+};
+
+/**
+ * @brief Encoded / formatted size of one entry, for CallSiteStats
+ */
+struct FormatSample {
+    DecoderFunc decoder;
+    uint32_t encoded_bytes;
+    uint32_t formatted_bytes;
+};
+
+/**
+ * @brief Unit of work handed from the merge stage to a format worker
+ *
+ * FREE -> (backend fills input) -> READY -> (worker formats) -> DONE
+ * -> (backend copies text to the output) -> FREE
+ */
+struct FormatChunk {
+    enum State : uint32_t { FREE = 0, READY, DONE, EXIT };
+
+    std::atomic<uint32_t> state{FREE};
+    std::vector<std::byte> input;          // Records (merge stage)
+    StringRingBuffer text;                 // Formatted lines (worker)
+    uint64_t lines{0};                     // Entries formatted into text
+    bool record_sizes{false};              // Fill samples for CallSiteStats
+    std::vector<FormatSample> samples;
+
+    explicit FormatChunk(size_t bytes) : text(bytes * 2) {
+        input.reserve(bytes * 2);
+    }
+};
+
+/**
+ * @brief Parallel formatting workers behind the backend's merge stage
+ *
+ * The backend thread stays the only consumer of the producer queues: it
+ * merges entries by timestamp and copies them into chunks numbered by a
+ * sequence counter. Chunk seq goes to worker seq % workers, which formats
+ * its chunks in order; the backend then appends finished chunks to the
+ * output strictly in sequence order, so the log file stays globally
+ * ordered while decoding scales with the number of workers.
+ *
+ * Decoders only read their arguments and the formatting helpers they use
+ * (timestamps, symbolizer, errno text) are thread-safe, so any entry can
+ * be formatted on any worker. Every method except the worker loop is
+ * called on the backend thread.
+ */
+class FormatPool {
+public:
+    using FormatFunc = void (*)(const Metadata& metadata, const std::byte* args, std::string_view context,
+                                StringRingBuffer::StringWriter& writer);
+
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;     // Submit once this much input is queued
+    static constexpr size_t CHUNKS_PER_WORKER = 4;       // In flight per worker
+
+    FormatPool(size_t workers, FormatFunc format)
+        : workers_(workers == 0 ? 1 : workers)
+        , format_(format) {
+        chunks_.reserve(workers_ * CHUNKS_PER_WORKER);
+        for (size_t i = 0; i < workers_ * CHUNKS_PER_WORKER; ++i) {
+            chunks_.push_back(std::make_unique<FormatChunk>(CHUNK_BYTES));
+        }
+        threads_.reserve(workers_);
+        for (size_t w = 0; w < workers_; ++w) {
+            threads_.emplace_back([this, w]() { worker_loop(w); });
+        }
+    }
+
+    /**
+     * @brief Stop the workers
+     * The backend writes every chunk before; any left are formatted and discarded.
+     */
+    ~FormatPool() {
+        submit();
+        while (FormatChunk* done = next_done(true)) {
+            release(*done);
+        }
+        for (size_t w = 0; w < workers_; ++w) {
+            // The slot a worker waits on next is FREE; anything else is still owned by the pipeline
+            FormatChunk& next = chunk(next_fill_ + w);
+            uint32_t expected = FormatChunk::FREE;
+            next.state.compare_exchange_strong(expected, FormatChunk::EXIT, std::memory_order_release);
+            next.state.notify_all();
+        }
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    FormatPool(const FormatPool&) = delete;
+    FormatPool& operator=(const FormatPool&) = delete;
+
+    size_t workers() const {
+        return workers_;
+    }
+
+    /**
+     * @brief Chunk being filled, or nullptr while its slot still holds an unwritten chunk
+     */
+    FormatChunk* fill_chunk() {
+        FormatChunk& next = chunk(next_fill_);
+        return next.state.load(std::memory_order_acquire) == FormatChunk::FREE ? &next : nullptr;
+    }
+
+    /**
+     * @brief Append an encoded entry and the context prefix it is printed with
+     */
+    static void append_entry(FormatChunk& chunk, const std::byte* entry, size_t entry_size, std::string_view context) {
+        std::byte* body = append_record(chunk, static_cast<uint32_t>(entry_size), context.size());
+        std::memcpy(body, entry, entry_size);
+        if (!context.empty()) {
+            std::memcpy(body + entry_size, context.data(), context.size());
+        }
+    }
+
+    /**
+     * @brief Append text that is copied to the output unchanged
+     */
+    static void append_text(FormatChunk& chunk, std::string_view text) {
+        std::byte* body = append_record(chunk, 0, text.size());
+        if (!text.empty()) {
+            std::memcpy(body, text.data(), text.size());
+        }
+    }
+
+    /**
+     * @brief Hand the chunk being filled to its worker (no-op when empty)
+     */
+    void submit() {
+        FormatChunk& next = chunk(next_fill_);
+        if (next.input.empty() || next.state.load(std::memory_order_relaxed) != FormatChunk::FREE) {
+            return;
+        }
+        next.state.store(FormatChunk::READY, std::memory_order_release);
+        next.state.notify_all();
+        ++next_fill_;
+    }
+
+    /**
+     * @brief Oldest submitted chunk if it has been formatted
+     * @param wait Block until it is (returns nullptr only when nothing is in flight)
+     */
+    FormatChunk* next_done(bool wait) {
+        if (next_write_ == next_fill_) {
+            return nullptr;
+        }
+        FormatChunk& oldest = chunk(next_write_);
+        uint32_t state = oldest.state.load(std::memory_order_acquire);
+        while (state != FormatChunk::DONE) {
+            if (!wait) {
+                return nullptr;
+            }
+            oldest.state.wait(state, std::memory_order_acquire);
+            state = oldest.state.load(std::memory_order_acquire);
+        }
+        return &oldest;
+    }
+
+    /**
+     * @brief Return a written chunk to its worker's slots
+     */
+    void release(FormatChunk& done) {
+        done.input.clear();
+        done.lines = 0;
+        done.record_sizes = false;
+        done.samples.clear();
+        done.state.store(FormatChunk::FREE, std::memory_order_release);
+        done.state.notify_all();
+        ++next_write_;
+    }
+
+    /**
+     * @brief Whether every submitted chunk has been written
+     */
+    bool empty() const {
+        return next_write_ == next_fill_;
+    }
+
+private:
+    FormatChunk& chunk(uint64_t seq) {
+        return *chunks_[(seq % workers_) * CHUNKS_PER_WORKER + (seq / workers_) % CHUNKS_PER_WORKER];
+    }
+
+    static std::byte* append_record(FormatChunk& chunk, uint32_t entry_size, size_t extra_size) {
+        FormatRecord header{entry_size, static_cast<uint32_t>(extra_size)};
+        size_t offset = chunk.input.size();
+        size_t record_size = (sizeof(FormatRecord) + entry_size + extra_size + 7) & ~size_t(7);
+        chunk.input.resize(offset + record_size);
+        std::memcpy(chunk.input.data() + offset, &header, sizeof(header));
+        return chunk.input.data() + offset + sizeof(FormatRecord);
+    }
+
+    void worker_loop(size_t worker) {
+        for (uint64_t seq = worker;; seq += workers_) {
+            FormatChunk& work = chunk(seq);
+            // The slot may still hold an older chunk (DONE, not yet written) or be FREE
+            uint32_t state = work.state.load(std::memory_order_acquire);
+            while (state != FormatChunk::READY && state != FormatChunk::EXIT) {
+                work.state.wait(state, std::memory_order_acquire);
+                state = work.state.load(std::memory_order_acquire);
+            }
+            if (state == FormatChunk::EXIT) {
+                return;
+            }
+            format_chunk(work);
+            work.state.store(FormatChunk::DONE, std::memory_order_release);
+            work.state.notify_all();
+        }
+    }
+
+    void format_chunk(FormatChunk& work) {
+        auto writer = work.text.get_writer();
+        const std::byte* data = work.input.data();
+        size_t pos = 0;
+        while (pos < work.input.size()) {
+            FormatRecord header;
+            std::memcpy(&header, data + pos, sizeof(header));
+            const std::byte* body = data + pos + sizeof(FormatRecord);
+            if (header.entry_size == 0) {
+                writer.append(reinterpret_cast<const char*>(body), header.extra_size);
+            } else {
+                Metadata metadata;
+                std::memcpy(&metadata, body, sizeof(Metadata));
+                const std::byte* args = metadata.args_size > 0 ? body + sizeof(Metadata) : nullptr;
+                std::string_view context(reinterpret_cast<const char*>(body + header.entry_size), header.extra_size);
+                size_t before = work.text.size();
+                format_(metadata, args, context, writer);
+                ++work.lines;
+                if (work.record_sizes) {
+                    work.samples.push_back({metadata.decoder, header.entry_size,
+                                            static_cast<uint32_t>(work.text.size() - before)});
+                }
+            }
+            pos += (sizeof(FormatRecord) + header.entry_size + header.extra_size + 7) & ~size_t(7);
+        }
+    }
+
+    size_t workers_;
+    FormatFunc format_;
+    std::vector<std::unique_ptr<FormatChunk>> chunks_;
+    std::vector<std::thread> threads_;
+    uint64_t next_fill_{0};    // Sequence number of the chunk being filled (backend thread)
+    uint64_t next_write_{0};   // Oldest chunk not yet written (backend thread)
+};
+
+} // namespace logZ
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace logZ {
+
+/**
+ * @brief Sparse time index of a log file ("<file>.log.idx")
+ *
+ * The Sinker adds one entry per block of index_block_bytes: the file offset
+ * of the first line starting in the block and that line's time. Lines print
+ * the UTC time of day ("INFO 13:45:07:123 ..."); the index stores it as Unix
+ * milliseconds, so binary search works across midnight.
+ *
+ * File format: LogIndexHeader followed by LogIndexEntry records (host byte order).
+ */
+struct LogIndexHeader {
+    static constexpr uint64_t MAGIC = 0x315844495A474F4CULL;  // "LOGZIDX1"
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t block_bytes;    // Spacing of the entries
+};
+
+struct LogIndexEntry {
+    uint64_t time_ms;        // Unix time of the line, millisecond precision
+    uint64_t offset;         // Byte offset of the line in the log file
+};
+
+inline constexpr uint64_t MS_PER_DAY = 86400000ull;
+
+/**
+ * @brief Parse the time of day of a log line ("LEVEL HH:MM:SS:mmm ...")
+ * @return false if the line does not start with a level and a timestamp
+ */
+inline bool parse_line_time(std::string_view line, uint32_t& ms_of_day) {
+    size_t space = line.find(' ');
+    if (space == std::string_view::npos || space == 0 || line.size() < space + 13) {
+        return false;
+    }
+    const char* t = line.data() + space + 1;
+    auto digit = [](char c) { return c >= '0' && c <= '9'; };
+    for (size_t i : {0, 1, 3, 4, 6, 7, 9, 10, 11}) {
+        if (!digit(t[i])) {
+            return false;
+        }
+    }
+    if (t[2] != ':' || t[5] != ':' || t[8] != ':') {
+        return false;
+    }
+    auto two = [t](size_t i) { return static_cast<uint32_t>((t[i] - '0') * 10 + (t[i + 1] - '0')); };
+    uint32_t hours = two(0), minutes = two(3), seconds = two(6);
+    if (hours > 23 || minutes > 59 || seconds > 59) {
+        return false;
+    }
+    uint32_t millis = static_cast<uint32_t>((t[9] - '0') * 100 + (t[10] - '0') * 10 + (t[11] - '0'));
+    ms_of_day = ((hours * 60 + minutes) * 60 + seconds) * 1000 + millis;
+    return true;
+}
+
+/**
+ * @brief Whether a line is a backend report ([STATS], [METRIC], [PROFILE], quota [WARN])
+ * Reports carry the time they are written rather than the time of the
+ * entries around them, so they are neither indexed nor used to stop an
+ * extraction.
+ */
+inline bool is_report_line(std::string_view line) {
+    if (line.starts_with("[STATS] ") || line.starts_with("[METRIC] ") || line.starts_with("[PROFILE] ")) {
+        return true;
+    }
+    constexpr std::string_view warn = "[WARN] ";
+    constexpr size_t timestamp_size = 12;  // HH:MM:SS:mmm
+    return line.starts_with(warn) &&
+           line.substr(std::min(line.size(), warn.size() + timestamp_size)).starts_with(" byte quota exceeded");
+}
+
+/**
+ * @brief Time of day of a line that orders the file (timestamped and not a report)
+ */
+inline bool parse_entry_time(std::string_view line, uint32_t& ms_of_day) {
+    return !is_report_line(line) && parse_line_time(line, ms_of_day);
+}
+
+/**
+ * @brief Unix time (ms) with the given UTC time of day that is closest to reference_ms
+ */
+inline uint64_t nearest_time_of_day(uint32_t ms_of_day, uint64_t reference_ms) {
+    uint64_t time = reference_ms - reference_ms % MS_PER_DAY + ms_of_day;
+    if (time > reference_ms + MS_PER_DAY / 2) {
+        time -= MS_PER_DAY;
+    } else if (time + MS_PER_DAY / 2 < reference_ms) {
+        time += MS_PER_DAY;
+    }
+    return time;
+}
+
+/**
+ * @brief Appends entries to an index file (Sinker side)
+ */
+class LogIndexWriter {
+public:
+    LogIndexWriter() = default;
+    ~LogIndexWriter() { close(); }
+
+    LogIndexWriter(const LogIndexWriter&) = delete;
+    LogIndexWriter& operator=(const LogIndexWriter&) = delete;
+
+    /**
+     * @brief Open (or continue) the index of a log file
+     * A partial entry left by an earlier failed write is cut off.
+     * @return false if the file cannot be opened or its header written
+     */
+    bool open(const std::string& path, uint32_t block_bytes) {
+        close();
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            return false;
+        }
+        off_t size = ::lseek(fd_, 0, SEEK_END);
+        bool ok;
+        if (size <= 0) {
+            LogIndexHeader header{LogIndexHeader::MAGIC, LogIndexHeader::VERSION, block_bytes};
+            ok = size == 0 && ::write(fd_, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+        } else {
+            off_t entries = size - static_cast<off_t>(sizeof(LogIndexHeader));
+            off_t whole = entries - entries % static_cast<off_t>(sizeof(LogIndexEntry));
+            ok = entries >= 0 && (whole == entries || ::ftruncate(fd_, whole + static_cast<off_t>(sizeof(LogIndexHeader))) == 0);
+        }
+        if (!ok) {
+            close();
+        }
+        return ok;
+    }
+
+    void close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    bool is_open() const {
+        return fd_ >= 0;
+    }
+
+    /**
+     * @return false if the entry was not (fully) written; the index is then unusable
+     */
+    bool add(uint64_t time_ms, uint64_t offset) {
+        LogIndexEntry entry{time_ms, offset};
+        return ::write(fd_, &entry, sizeof(entry)) == static_cast<ssize_t>(sizeof(entry));
+    }
+
+private:
+    int fd_{-1};
+};
+
+/**
+ * @brief Loaded index with binary search over the entries (reader side)
+ *
+ * Usage:
+ *   LogIndex index;
+ *   if (index.load("logs/2024-05-01_1.log.idx")) {
+ *       index.extract("logs/2024-05-01_1.log", from_ms, to_ms, stdout);
+ *   }
+ */
+class LogIndex {
+public:
+    /**
+     * @brief Read an index file
+     * @param error Receives the reason on failure (optional)
+     */
+    bool load(const std::string& path, std::string* error = nullptr) {
+        entries_.clear();
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            if (error != nullptr) {
+                *error = "cannot open " + path;
+            }
+            return false;
+        }
+        LogIndexHeader header{};
+        bool valid = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                     header.magic == LogIndexHeader::MAGIC && header.version == LogIndexHeader::VERSION;
+        if (valid) {
+            block_bytes_ = header.block_bytes;
+            LogIndexEntry entry;
+            while (std::fread(&entry, sizeof(entry), 1, file) == 1) {
+                entries_.push_back(entry);
+            }
+        } else if (error != nullptr) {
+            *error = path + " is not a logZ index";
+        }
+        std::fclose(file);
+        return valid;
+    }
+
+    const std::vector<LogIndexEntry>& entries() const {
+        return entries_;
+    }
+
+    uint32_t block_bytes() const {
+        return block_bytes_;
+    }
+
+    /**
+     * @brief Offset to start reading from so no line at or after time_ms is missed
+     * @return Entry of the last block that starts before time_ms (offset 0 if none)
+     */
+    LogIndexEntry seek(uint64_t time_ms) const {
+        auto it = std::lower_bound(entries_.begin(), entries_.end(), time_ms,
+                                   [](const LogIndexEntry& entry, uint64_t time) { return entry.time_ms < time; });
+        if (it == entries_.begin()) {
+            return {entries_.empty() ? time_ms : entries_.front().time_ms, 0};
+        }
+        return *(it - 1);
+    }
+
+    /**
+     * @brief Unix time (ms) of a time of day printed in this file
+     * Resolved within the day that starts at the first entry, so times after
+     * midnight map to the following date.
+     */
+    uint64_t resolve_time_of_day(uint32_t ms_of_day) const {
+        uint64_t first = entries_.empty() ? 0 : entries_.front().time_ms;
+        return nearest_time_of_day(ms_of_day, first + MS_PER_DAY / 2);
+    }
+
+    /**
+     * @brief Write the lines of [from_ms, to_ms] to out
+     * Lines without a timestamp (stack frames) and reports follow the line before them.
+     * @return Number of lines written, or -1 if the log cannot be read
+     */
+    long extract(const std::string& log_path, uint64_t from_ms, uint64_t to_ms, FILE* out) const {
+        FILE* file = std::fopen(log_path.c_str(), "rb");
+        if (file == nullptr) {
+            return -1;
+        }
+        LogIndexEntry start = seek(from_ms);
+        std::fseek(file, static_cast<long>(start.offset), SEEK_SET);
+
+        long written = 0;
+        bool in_range = false;
+        uint64_t last_ms = start.time_ms;
+        char* line = nullptr;
+        size_t capacity = 0;
+        ssize_t length;
+        while ((length = ::getline(&line, &capacity, file)) > 0) {
+            uint32_t ms_of_day;
+            if (parse_entry_time(std::string_view(line, static_cast<size_t>(length)), ms_of_day)) {
+                last_ms = nearest_time_of_day(ms_of_day, last_ms);
+                if (last_ms > to_ms) {
+                    break;
+                }
+                in_range = last_ms >= from_ms;
+            }
+            if (in_range) {
+                std::fwrite(line, 1, static_cast<size_t>(length), out);
+                ++written;
+            }
+        }
+        std::free(line);
+        std::fclose(file);
+        return written;
+    }
+
+private:
+    std::vector<LogIndexEntry> entries_;
+    uint32_t block_bytes_{0};
+};
+
+} // namespace logZ
@@ -89,6 +89,17 @@ class StringRingBuffer;
  */
 using DecoderFunc = void (*)(const std::byte*, void*);
 
+/**
+ * @brief Kind of a queue entry
+ * Non-LOG entries carry state for the Backend and produce no output line
+ */
+enum class EntryKind : uint8_t {
+    LOG = 0,       // Regular LOG_xxx message
+    CONTEXT = 1,        // Thread context changed (args: rendered context string)
+    TRACE_BEGIN = 2,    // TRACE_BEGIN / TRACE_SCOPE entry (args: span name)
+    TRACE_END = 3       // TRACE_END / end of TRACE_SCOPE
+};
+
 /**
  * @brief Log metadata stored at the beginning of each log entry
  * 
@@ -97,7 +108,8 @@ using DecoderFunc = void (*)(const std::byte*, void*);
  * - decoder:   8 bytes (offset 8)
  * - args_size: 4 bytes (offset 16)
  * - level:     1 byte  (offset 20)
- * - padding:   3 bytes (offset 21-23)
+ * - kind:      1 byte  (offset 21)
+ * - dropped_before: 2 bytes (offset 22-23)
  * 
  * 原布局需要 32 bytes，优化后只需 24 bytes
  */
@@ -106,7 +118,10 @@ struct Metadata {
     DecoderFunc decoder;     // Function pointer (8 bytes)
     uint32_t args_size;      // Size of arguments in bytes (4 bytes)
     LogLevel level;          // Log level (1 byte)
-    // 3 bytes padding to align to 8 bytes
+    EntryKind kind;          // Entry kind (1 byte)
+    uint16_t dropped_before; // Entries the thread dropped since its previous entry, saturating (2 bytes)
 };
 
+static_assert(sizeof(Metadata) == 24, "Metadata layout");
+
 } // namespace logZ
@@ -5,13 +5,25 @@
 #include "Decoder.h"
 #include "Encoder.h"
 #include "Fixedstring.h"
+#include "CallSite.h"
 #include "Backend.h"
+#include "PerCpuQueues.h"
+#include "MpscRing.h"
+#include "Probes.h"
 
+#include <algorithm>
+#include <charconv>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <tuple>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <x86intrin.h>  // For __rdtsc()
 
 namespace logZ {
@@ -20,6 +32,8 @@ namespace logZ {
 template<LogLevel MinLevel>
 class Backend;
 
+class ScopedContext;
+
 template<LogLevel MinLevel>
 class QueueRegistration;
 
@@ -84,18 +98,192 @@ public:
      */
     static Queue& get_thread_queue();
 
+    /**
+     * @brief Set the runtime level threshold of the calling thread
+     * @param level Minimum level this thread logs (LOGZ_MIN_LEVEL still applies)
+     * 
+     * Stored next to the thread's queue pointer, so the LOG_xxx check is a
+     * load from a cache line the thread already touches. Other threads are
+     * unaffected; see also Backend::set_thread_level(). The level is then
+     * explicit: Backend::set_default_thread_level() no longer changes it.
+     */
+    static void set_thread_level(LogLevel level) {
+        tls_context_.level_explicit.store(true, std::memory_order_relaxed);
+        tls_context_.level.store(level, std::memory_order_relaxed);
+        tls_context_.level_initialized = true;
+    }
+
+    /**
+     * @brief Get the runtime level threshold of the calling thread
+     */
+    static LogLevel thread_level() {
+        return tls_context_.level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Runtime level check used by the LOG_xxx macros
+     */
+    __attribute__((always_inline))
+    static bool thread_level_enabled(LogLevel level) {
+        return level >= tls_context_.level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Mark the calling thread as transient
+     * Its entries go to the Backend's shared MPSC ring instead of a per-thread
+     * Queue: no registry mutex, no queue allocation, nothing orphaned on exit.
+     * Call before the thread's first LOG_xxx.
+     */
+    static void mark_thread_transient() {
+        tls_context_.transient = true;
+    }
+
+    /**
+     * @brief Open a trace span on the calling thread (TRACE_BEGIN / TRACE_SCOPE)
+     * @param active Whether the BEGIN entry may be written (tracing and call site enabled)
+     * @return true if the caller writes the BEGIN entry, then reports the
+     *         outcome with trace_begin_written()
+     * 
+     * Spans nest per thread: one bit per open span records whether its BEGIN
+     * was written, so trace_end() writes END only for those. With no span
+     * open, an inactive BEGIN is not tracked (its END finds an empty stack).
+     */
+    __attribute__((always_inline))
+    static bool trace_begin(bool active) {
+        uint32_t depth = tls_context_.trace_depth;
+        if (!active && depth == 0) [[likely]] {
+            return false;
+        }
+        tls_context_.trace_depth = depth + 1;
+        if (depth >= MAX_TRACE_DEPTH) [[unlikely]] {
+            return false;  // Too deep to track: neither BEGIN nor END
+        }
+        tls_context_.trace_written &= ~(uint64_t{1} << depth);
+        return active;
+    }
+
+    /**
+     * @brief Record whether the BEGIN of the innermost span was committed
+     * Called after trace_begin() returned true; a BEGIN dropped on a full
+     * queue gets no END.
+     */
+    __attribute__((always_inline))
+    static void trace_begin_written(bool written) {
+        tls_context_.trace_written |= uint64_t{written} << (tls_context_.trace_depth - 1);
+    }
+
+    /**
+     * @brief Close the innermost trace span (TRACE_END / end of TRACE_SCOPE)
+     * @return true if its BEGIN was written and the caller writes the END entry
+     */
+    __attribute__((always_inline))
+    static bool trace_end() {
+        uint32_t depth = tls_context_.trace_depth;
+        if (depth == 0) [[likely]] {
+            return false;
+        }
+        tls_context_.trace_depth = --depth;
+        return depth < MAX_TRACE_DEPTH && (tls_context_.trace_written >> depth & 1);
+    }
+
     /**
      * @brief Log a message with variadic template parameters
      * @tparam Fmt Format string (compile-time constant)
      * @tparam Level Log level (compile-time constant)
+     * @tparam Kind Entry kind (LOG, or TRACE_xxx for the trace macros)
      * @tparam Args Types of arguments to log
      * @param args Arguments to serialize and log
+     * @return true if the entry was committed (false: filtered, over quota or dropped)
      * Note: Level check should be done at macro level before calling this function
      */
-    template<auto Fmt, LogLevel Level, typename... Args>
-    static void log_impl(const Args&... args);
+    template<auto Fmt, LogLevel Level, EntryKind Kind = EntryKind::LOG, typename... Args>
+    static bool log_impl(const Args&... args);
 
 private:
+    friend class ScopedContext;
+
+    /**
+     * @brief Per-thread producer state
+     * Trivially constructible/destructible so access needs no TLS init guard
+     */
+    struct ThreadContext {
+        Queue* queue{nullptr};                  // Borrowed queue, nullptr until first log (or while on the shared ring)
+        std::atomic<LogLevel> level{MinLevel};  // Runtime threshold (written by Backend::set_thread_level() too)
+        bool level_initialized{false};          // level taken from set_thread_level() or the Backend default
+        std::atomic<bool> level_explicit{false}; // Set by a set_thread_level(): the Backend default no longer applies
+        bool transient{false};                  // Set by mark_thread_transient()
+        uint32_t shared_entries{0};             // Entries written to the shared ring
+        uint32_t pending_drops{0};              // Entries dropped since the last queued one (see Metadata::dropped_before)
+        bool context_dirty{false};              // ScopedContext fields changed since the last CONTEXT record
+        uint32_t trace_depth{0};                // Open trace spans (see trace_begin())
+        uint64_t trace_written{0};              // Bit N: BEGIN of the span at depth N was written
+    };
+    static thread_local ThreadContext tls_context_;
+
+    // A thread placed on the shared ring automatically is promoted to its
+    // own Queue once it has logged this many entries
+    static constexpr uint32_t SHARED_PROMOTE_AFTER = 64;
+
+    // Nesting depth up to which trace spans are tracked (bits of trace_written)
+    static constexpr uint32_t MAX_TRACE_DEPTH = 64;
+
+    // Outcome of log_per_cpu()
+    enum class PerCpuWrite : uint8_t {
+        WRITTEN,        // Entry committed
+        NOT_WRITTEN,    // Filtered by level or dropped on a full queue
+        NO_SLOT,        // Every slot owned: not attempted
+    };
+
+    /**
+     * @brief Take the Backend's default level unless set_thread_level() was called
+     */
+    static void init_thread_level() {
+        if (!tls_context_.level_initialized) {
+            tls_context_.level.store(get_backend<MinLevel>().default_thread_level(), std::memory_order_relaxed);
+            tls_context_.level_initialized = true;
+        }
+    }
+
+    /**
+     * @brief Slow path for a thread without a Queue
+     * @return Queue to use, or nullptr if the entry goes to the shared ring
+     */
+    __attribute__((noinline, cold))
+    static Queue* acquire_thread_queue() {
+        init_thread_level();
+        if (tls_context_.transient) {
+            return nullptr;
+        }
+        if (get_backend<MinLevel>().transient_by_default() &&
+            tls_context_.shared_entries < SHARED_PROMOTE_AFTER) {
+            ++tls_context_.shared_entries;
+            return nullptr;
+        }
+        return &get_thread_queue();
+    }
+
+    /**
+     * @brief Write an entry into the Backend's shared MPSC ring
+     * @return false if the ring is full
+     */
+    template<auto Fmt, LogLevel Level, EntryKind Kind = EntryKind::LOG, typename... Args>
+    __attribute__((noinline))
+    static bool log_shared(uint64_t timestamp, size_t args_size, const Args&... args);
+
+    /**
+     * @brief Write the calling thread's current ScopedContext prefix into its queue
+     * Called by log_impl() before the first entry after the fields changed
+     */
+    static void log_context(Queue& queue, uint64_t timestamp);
+
+    /**
+     * @brief log_impl() variant writing into the current CPU's queue
+     * Selected at compile time with LOGZ_PER_CPU_QUEUES
+     * @return NO_SLOT if every slot is owned (the caller uses the thread's own queue)
+     */
+    template<auto Fmt, LogLevel Level, EntryKind Kind = EntryKind::LOG, typename... Args>
+    static PerCpuWrite log_per_cpu(const Args&... args);
+
     /**
      * @brief Get current timestamp using RDTSC (ultra-low latency)
      * 使用 RDTSC 获取时间戳，比 chrono 快约 3-5 倍
@@ -115,11 +303,13 @@ private:
 
 namespace logZ {
 
+inline thread_local Logger::ThreadContext Logger::tls_context_;
+
 // Implementation of get_thread_queue() - must be after Backend is complete
 // 使用 RAII guard 确保线程退出时自动清理
 inline Queue& Logger::get_thread_queue() {
-    // 裸指针 TLS：访问更快（避免 struct 间接访问）
-    static thread_local Queue* tls_queue = nullptr;
+    // 裸指针 TLS：访问更快（无需 TLS 初始化检查）
+    Queue*& tls_queue = tls_context_.queue;
     
     // RAII guard：负责线程退出时的清理
     // 只在第一次初始化时创建，析构时标记队列为 orphaned
@@ -140,7 +330,7 @@ inline Queue& Logger::get_thread_queue() {
     
     // 慢速路径：首次初始化
     auto& backend = Logger::get_backend<MinLevel>();
-    tls_queue = backend.allocate_queue_for_thread();
+    tls_queue = backend.allocate_queue_for_thread(&tls_context_.level, &tls_context_.level_explicit);
     
     if (!tls_queue) [[unlikely]] {
         throw std::runtime_error("Failed to allocate queue from Backend");
@@ -151,9 +341,17 @@ inline Queue& Logger::get_thread_queue() {
 }
 
 // Implementation of log_impl() - must be after Backend is complete
-template<auto Fmt, LogLevel Level, typename... Args>
+template<auto Fmt, LogLevel Level, EntryKind Kind, typename... Args>
 __attribute__((always_inline, hot))
-void Logger::log_impl(const Args&... args) {
+bool Logger::log_impl(const Args&... args) {
+    if constexpr (LOGZ_PER_CPU_QUEUES) {
+        // Every slot owned by a preempted writer: fall through to the thread's own queue
+        PerCpuWrite result = log_per_cpu<Fmt, Level, Kind>(args...);
+        if (result != PerCpuWrite::NO_SLOT) [[likely]] {
+            return result == PerCpuWrite::WRITTEN;
+        }
+    }
+
     // 获取 TSC 时间戳（比 chrono 快 3-5 倍）
     auto timestamp = get_timestamp_ns();
     
@@ -161,8 +359,36 @@ void Logger::log_impl(const Args&... args) {
     size_t args_size = calculate_args_size(args...);
     size_t total_size = sizeof(Metadata) + args_size;
 
+    // Hot path: thread already owns a queue
+    Queue* queue_ptr = tls_context_.queue;
+    if (queue_ptr == nullptr) [[unlikely]] {
+        queue_ptr = acquire_thread_queue();
+        // First entry of this thread: its level was just set from the Backend default
+        if (Kind == EntryKind::LOG && !thread_level_enabled(Level)) {
+            return false;
+        }
+        if (queue_ptr == nullptr) {
+            return log_shared<Fmt, Level, Kind>(timestamp, args_size, args...);
+        }
+    }
+
     // Reserve space in queue
-    Queue& queue = get_thread_queue();
+    Queue& queue = *queue_ptr;
+
+    // ScopedContext changed since this thread's last entry: send the new prefix first
+    if (tls_context_.context_dirty) [[unlikely]] {
+        log_context(queue, timestamp);
+    }
+
+    // Optional byte-rate quota: over-quota entries are counted, not queued
+    if (Kind == EntryKind::LOG && queue.quota().limited()) [[unlikely]] {
+        if (!queue.quota().admit(total_size, timestamp)) {
+            LOGZ_PROBE2(quota_reject, static_cast<int>(Level), total_size);
+            ++tls_context_.pending_drops;
+            return false;
+        }
+    }
+
     std::byte* buffer = queue.reserve_write(total_size);
     
     // Hot path: Buffer allocation usually succeeds
@@ -170,17 +396,273 @@ void Logger::log_impl(const Args&... args) {
         // Queue is full, log message lost
         // Increment dropped messages counter
         get_backend<MinLevel>().increment_dropped_count();
-        return;
+        ++tls_context_.pending_drops;
+        LOGZ_PROBE2(drop, static_cast<int>(Level), total_size);
+        return false;
     }
 
     // Encode metadata and arguments into buffer using Encoder functions
     // Pass args_size to avoid redundant calculation
-    encode_log_entry<Fmt, Level>(buffer, timestamp, args_size, args...);
+    encode_log_entry<Fmt, Level, Kind>(buffer, timestamp, args_size, args...);
+
+    // Drops since the previous entry: the backend writes a marker at this point
+    if (tls_context_.pending_drops != 0) [[unlikely]] {
+        reinterpret_cast<Metadata*>(buffer)->dropped_before =
+            static_cast<uint16_t>(std::min<uint32_t>(tls_context_.pending_drops, UINT16_MAX));
+        tls_context_.pending_drops = 0;
+    }
     
     // Commit the write to make data visible to backend thread
     queue.commit_write(total_size);
+
+    // Wake a poll-mode backend if it is blocked on its eventfd
+    Backend<MinLevel>::notify_if_waiting();
+    return true;
+}
+
+template<auto Fmt, LogLevel Level, EntryKind Kind, typename... Args>
+bool Logger::log_shared(uint64_t timestamp, size_t args_size, const Args&... args) {
+    auto& backend = get_backend<MinLevel>();
+    MpscRing& ring = backend.shared_ring();
+    std::byte* buffer = ring.reserve_write(sizeof(Metadata) + args_size);
+    if (buffer == nullptr) [[unlikely]] {
+        backend.increment_dropped_count();
+        LOGZ_PROBE2(drop, static_cast<int>(Level), sizeof(Metadata) + args_size);
+        return false;
+    }
+
+    encode_log_entry<Fmt, Level, Kind>(buffer, timestamp, args_size, args...);
+    ring.commit_write(buffer);
+
+    Backend<MinLevel>::notify_if_waiting();
+    return true;
+}
+
+template<auto Fmt, LogLevel Level, EntryKind Kind, typename... Args>
+__attribute__((always_inline, hot))
+Logger::PerCpuWrite Logger::log_per_cpu(const Args&... args) {
+    if (!tls_context_.level_initialized) [[unlikely]] {
+        init_thread_level();
+        if (Kind == EntryKind::LOG && !thread_level_enabled(Level)) {
+            return PerCpuWrite::NOT_WRITTEN;
+        }
+    }
+
+    size_t args_size = calculate_args_size(args...);
+    size_t total_size = sizeof(Metadata) + args_size;
+
+    auto& backend = get_backend<MinLevel>();
+    PerCpuQueues& per_cpu = backend.per_cpu_queues();
+    PerCpuQueues::Slot* slot = per_cpu.acquire();
+    if (slot == nullptr) [[unlikely]] {
+        return PerCpuWrite::NO_SLOT;
+    }
+
+    // Timestamp taken while owning the slot keeps each CPU queue in TSC order
+    auto timestamp = get_timestamp_ns();
+
+    std::byte* buffer = slot->queue->reserve_write(total_size);
+    if (buffer == nullptr) [[unlikely]] {
+        per_cpu.release(slot);
+        backend.increment_dropped_count();
+        LOGZ_PROBE2(drop, static_cast<int>(Level), total_size);
+        return PerCpuWrite::NOT_WRITTEN;
+    }
+
+    encode_log_entry<Fmt, Level, Kind>(buffer, timestamp, args_size, args...);
+    slot->queue->commit_write(total_size);
+    per_cpu.release(slot);
+
+    Backend<MinLevel>::notify_if_waiting();
+    return PerCpuWrite::WRITTEN;
+}
+
+/**
+ * @brief Thread-local context field (MDC) for the lifetime of a scope
+ * 
+ * Usage:
+ *   logZ::ScopedContext request("request_id", req.id);
+ *   LOG_INFO("Order accepted {}", qty);   // -> "[INFO] 12:00:00:000 [request_id=42] Order accepted 10"
+ * 
+ * Opening or closing a scope only changes the calling thread's fields and
+ * marks them changed. The next entry the thread logs is preceded by a single
+ * context record with the rendered fields ("[k1=v1 k2=v2] "); the Backend
+ * keeps the current prefix per queue and prepends it to every following
+ * line. Scopes that log nothing cost no queue traffic, and LOG_xxx calls
+ * inside a scope encode nothing extra.
+ * 
+ * Values may be strings or arithmetic types. Scopes must nest (RAII).
+ * Not available with LOGZ_PER_CPU_QUEUES or for threads on the shared ring.
+ */
+class ScopedContext {
+public:
+    template<typename T>
+    ScopedContext(std::string_view key, const T& value) {
+        thread_fields().emplace_back(std::string(key), to_field_string(value));
+        Logger::tls_context_.context_dirty = true;
+    }
+
+    ~ScopedContext() {
+        thread_fields().pop_back();
+        Logger::tls_context_.context_dirty = true;
+    }
+
+    ScopedContext(const ScopedContext&) = delete;
+    ScopedContext& operator=(const ScopedContext&) = delete;
+    ScopedContext(ScopedContext&&) = delete;
+    ScopedContext& operator=(ScopedContext&&) = delete;
+
+private:
+    friend class Logger;
+
+    using Fields = std::vector<std::pair<std::string, std::string>>;
+
+    static Fields& thread_fields() {
+        static thread_local Fields fields;
+        return fields;
+    }
+
+    template<typename T>
+    static std::string to_field_string(const T& value) {
+        using RawT = std::remove_cv_t<std::remove_reference_t<T>>;
+        if constexpr (std::is_same_v<RawT, bool>) {
+            return value ? "true" : "false";
+        } else if constexpr (std::is_arithmetic_v<RawT>) {
+            char buffer[64];
+            auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            return std::string(buffer, ec == std::errc() ? end : buffer);
+        } else {
+            return std::string(std::string_view(value));
+        }
+    }
+
+    /**
+     * @brief Prefix of the calling thread's fields ("" without fields)
+     */
+    static std::string render() {
+        const Fields& fields = thread_fields();
+        std::string rendered;
+        if (!fields.empty()) {
+            rendered += '[';
+            for (size_t i = 0; i < fields.size(); ++i) {
+                if (i > 0) {
+                    rendered += ' ';
+                }
+                rendered += fields[i].first;
+                rendered += '=';
+                rendered += fields[i].second;
+            }
+            rendered += "] ";
+        }
+        // Length is stored as 2 bytes in the record
+        if (rendered.size() > UINT16_MAX) {
+            rendered.resize(UINT16_MAX);
+        }
+        return rendered;
+    }
+};
+
+__attribute__((noinline, cold))
+inline void Logger::log_context(Queue& queue, uint64_t timestamp) {
+    if constexpr (LOGZ_PER_CPU_QUEUES) {
+        // A CPU queue is shared by many threads: no per-thread context
+        tls_context_.context_dirty = false;
+        return;
+    }
+
+    std::string context = ScopedContext::render();
+    size_t total_size = sizeof(Metadata) + calculate_single_arg_size(std::string_view(context));
+    std::byte* buffer = queue.reserve_write(total_size);
+    if (buffer == nullptr) [[unlikely]] {
+        LOGZ_PROBE2(drop, -1, total_size);
+        return;  // Queue full: retried before the thread's next entry
+    }
+    encode_context_entry(buffer, timestamp, context);
+    queue.commit_write(total_size);
+    tls_context_.context_dirty = false;
 }
 
+/**
+ * @brief RAII timer behind LOG_SCOPE_TIMER
+ * 
+ * Reads the TSC on construction and, on destruction, logs one entry whose
+ * first encoded argument is the ScopeTiming pair. The Backend formats the
+ * message and appends the duration converted with TscCalibration.
+ * 
+ * Arguments are stored as decayed copies; a const char* argument must stay
+ * valid until the scope ends.
+ */
+template<auto Fmt, LogLevel Level, typename... Args>
+class ScopeTimer {
+public:
+    template<typename... Ts>
+    explicit ScopeTimer(bool active, Ts&&... args)
+        : start_tsc_(active ? __rdtsc() : 0)
+        , active_(active)
+        , args_(std::forward<Ts>(args)...) {}
+
+    ~ScopeTimer() {
+        if (active_) {
+            ScopeTiming timing{start_tsc_, __rdtsc()};
+            std::apply([&timing](const auto&... args) {
+                Logger::log_impl<Fmt, Level>(timing, args...);
+            }, args_);
+        }
+    }
+
+    ScopeTimer(const ScopeTimer&) = delete;
+    ScopeTimer& operator=(const ScopeTimer&) = delete;
+    ScopeTimer(ScopeTimer&&) = delete;
+    ScopeTimer& operator=(ScopeTimer&&) = delete;
+
+private:
+    uint64_t start_tsc_;
+    bool active_;
+    std::tuple<Args...> args_;
+};
+
+/**
+ * @brief Create a ScopeTimer (deduces the stored argument types)
+ * @param active false if the level or call site is disabled (no TSC read, no entry)
+ */
+template<auto Fmt, LogLevel Level, typename... Args>
+ScopeTimer<Fmt, Level, std::decay_t<Args>...> make_scope_timer(bool active, Args&&... args) {
+    return ScopeTimer<Fmt, Level, std::decay_t<Args>...>(active, std::forward<Args>(args)...);
+}
+
+/**
+ * @brief RAII span behind TRACE_SCOPE
+ * Writes a TRACE_BEGIN entry when created and a TRACE_END entry on scope exit
+ */
+class TraceScope {
+public:
+    /**
+     * @brief Open a span
+     * @param active false if tracing or the call site is disabled (no entries)
+     */
+    template<auto Fmt, typename... Args>
+    static TraceScope begin(bool active, const Args&... args) {
+        if (Logger::trace_begin(active)) {
+            Logger::trace_begin_written(Logger::log_impl<Fmt, LogLevel::TRACE, EntryKind::TRACE_BEGIN>(args...));
+        }
+        return TraceScope();
+    }
+
+    ~TraceScope() {
+        if (Logger::trace_end()) {
+            Logger::log_impl<FixedString(""), LogLevel::TRACE, EntryKind::TRACE_END>();
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+    TraceScope(TraceScope&&) = delete;
+    TraceScope& operator=(TraceScope&&) = delete;
+
+private:
+    TraceScope() = default;
+};
+
 } // namespace logZ
 
 // Helper macros to extract first argument and remaining arguments
@@ -191,44 +673,106 @@ void Logger::log_impl(const Args&... args) {
 // Format: LOG_INFO("format string {}", arg1, arg2, ...)
 // All macros use the same Logger class (no template parameter) to share the same thread_local queue
 // Compile-time level check is done at macro expansion time
+// Runtime checks (thread level in TLS, per-call-site switch from CallSite.h) run before
+// touching the queue or the TSC
 #define LOG_TRACE(fmt, ...) \
     do { \
         if constexpr (::logZ::LogLevel::TRACE >= ::logZ::Logger::MinLevel) { \
-            ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::TRACE>(__VA_ARGS__); \
+            if (::logZ::Logger::thread_level_enabled(::logZ::LogLevel::TRACE) && \
+                LOGZ_CALL_SITE(::logZ::LogLevel::TRACE, fmt).is_enabled()) [[likely]] { \
+                ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::TRACE>(__VA_ARGS__); \
+            } \
         } \
     } while(0)
 
 #define LOG_DEBUG(fmt, ...) \
     do { \
         if constexpr (::logZ::LogLevel::DEBUG >= ::logZ::Logger::MinLevel) { \
-            ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::DEBUG>(__VA_ARGS__); \
+            if (::logZ::Logger::thread_level_enabled(::logZ::LogLevel::DEBUG) && \
+                LOGZ_CALL_SITE(::logZ::LogLevel::DEBUG, fmt).is_enabled()) [[likely]] { \
+                ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::DEBUG>(__VA_ARGS__); \
+            } \
         } \
     } while(0)
 
 #define LOG_INFO(fmt, ...) \
     do { \
         if constexpr (::logZ::LogLevel::INFO >= ::logZ::Logger::MinLevel) { \
-            ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::INFO>(__VA_ARGS__); \
+            if (::logZ::Logger::thread_level_enabled(::logZ::LogLevel::INFO) && \
+                LOGZ_CALL_SITE(::logZ::LogLevel::INFO, fmt).is_enabled()) [[likely]] { \
+                ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::INFO>(__VA_ARGS__); \
+            } \
         } \
     } while(0)
 
 #define LOG_WARN(fmt, ...) \
     do { \
         if constexpr (::logZ::LogLevel::WARN >= ::logZ::Logger::MinLevel) { \
-            ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::WARN>(__VA_ARGS__); \
+            if (::logZ::Logger::thread_level_enabled(::logZ::LogLevel::WARN) && \
+                LOGZ_CALL_SITE(::logZ::LogLevel::WARN, fmt).is_enabled()) [[likely]] { \
+                ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::WARN>(__VA_ARGS__); \
+            } \
         } \
     } while(0)
 
 #define LOG_ERROR(fmt, ...) \
     do { \
         if constexpr (::logZ::LogLevel::ERROR >= ::logZ::Logger::MinLevel) { \
-            ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::ERROR>(__VA_ARGS__); \
+            if (::logZ::Logger::thread_level_enabled(::logZ::LogLevel::ERROR) && \
+                LOGZ_CALL_SITE(::logZ::LogLevel::ERROR, fmt).is_enabled()) [[likely]] { \
+                ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::ERROR>(__VA_ARGS__); \
+            } \
         } \
     } while(0)
 
 #define LOG_FATAL(fmt, ...) \
     do { \
         if constexpr (::logZ::LogLevel::FATAL >= ::logZ::Logger::MinLevel) { \
-            ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::FATAL>(__VA_ARGS__); \
+            if (::logZ::Logger::thread_level_enabled(::logZ::LogLevel::FATAL) && \
+                LOGZ_CALL_SITE(::logZ::LogLevel::FATAL, fmt).is_enabled()) [[likely]] { \
+                ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::FATAL>(__VA_ARGS__); \
+            } \
         } \
     } while(0)
+
+#define LOGZ_CONCAT_IMPL(a, b) a##b
+#define LOGZ_CONCAT(a, b) LOGZ_CONCAT_IMPL(a, b)
+
+// Time the rest of the enclosing scope
+// Format: LOG_SCOPE_TIMER("load {}", path) -> "[INFO] ... load /etc/x took 1.234ms"
+// Logs one INFO entry on scope exit holding both TSC values
+#define LOG_SCOPE_TIMER(fmt, ...) \
+    auto LOGZ_CONCAT(logz_scope_timer_, __LINE__) = \
+        ::logZ::make_scope_timer<::logZ::FixedString(fmt), ::logZ::LogLevel::INFO>( \
+            ::logZ::LogLevel::INFO >= ::logZ::Logger::MinLevel && \
+            ::logZ::Logger::thread_level_enabled(::logZ::LogLevel::INFO) && \
+            LOGZ_CALL_SITE(::logZ::LogLevel::INFO, fmt).is_enabled() __VA_OPT__(,) __VA_ARGS__)
+
+// Trace spans (Chrome JSON trace, see Backend::open_trace_file())
+// Written through the same per-thread queues as logs; the name is formatted by the backend
+// TRACE_BEGIN("match {}", order_id); ... TRACE_END();   // END written only if its BEGIN was committed
+// TRACE_SCOPE("match {}", order_id);   // Ends with the enclosing scope
+#define LOGZ_TRACE_ACTIVE(fmt) \
+    (::logZ::Backend<::logZ::Logger::MinLevel>::tracing_enabled() && \
+     LOGZ_CALL_SITE(::logZ::LogLevel::TRACE, fmt).is_enabled())
+
+#define TRACE_BEGIN(fmt, ...) \
+    do { \
+        if (::logZ::Logger::trace_begin(LOGZ_TRACE_ACTIVE(fmt))) [[unlikely]] { \
+            ::logZ::Logger::trace_begin_written( \
+                ::logZ::Logger::log_impl<::logZ::FixedString(fmt), ::logZ::LogLevel::TRACE, \
+                                         ::logZ::EntryKind::TRACE_BEGIN>(__VA_ARGS__)); \
+        } \
+    } while(0)
+
+#define TRACE_END() \
+    do { \
+        if (::logZ::Logger::trace_end()) [[unlikely]] { \
+            ::logZ::Logger::log_impl<::logZ::FixedString(""), ::logZ::LogLevel::TRACE, \
+                                     ::logZ::EntryKind::TRACE_END>(); \
+        } \
+    } while(0)
+
+#define TRACE_SCOPE(fmt, ...) \
+    auto LOGZ_CONCAT(logz_trace_scope_, __LINE__) = \
+        ::logZ::TraceScope::begin<::logZ::FixedString(fmt)>(LOGZ_TRACE_ACTIVE(fmt) __VA_OPT__(,) __VA_ARGS__)
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "Decoder.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fnmatch.h>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace logZ {
+
+/**
+ * @brief Current value of one aggregated metric
+ */
+struct MetricSnapshot {
+    std::string name;               // Metric name given at registration
+    std::string pattern;            // Format-string pattern it is attached to
+    uint64_t count;                 // Matching messages
+    double sum;                     // Histograms: sum of observed values
+    double min;                     // Histograms: smallest value (0 if count == 0)
+    double max;                     // Histograms: largest value (0 if count == 0)
+    std::vector<double> bounds;     // Histograms: bucket upper bounds (empty for counters)
+    std::vector<uint64_t> buckets;  // Histograms: per-bucket counts, last one is +Inf
+};
+
+/**
+ * @brief Log-to-metrics aggregation on the backend thread
+ * 
+ * A metric is attached to every call site whose format string matches a
+ * shell glob (fnmatch). Matching messages are counted, and a histogram also
+ * observes one numeric argument, read from the encoded bytes through the
+ * decoder's ArgExtractor - the message is never formatted for this.
+ * 
+ * Call sites are resolved lazily: the first message of a decoder looks up
+ * its format in DecoderRegistry and caches the matching metrics, so later
+ * messages cost one hash lookup.
+ * 
+ * Only the backend thread records, and the call-site cache is its own: it
+ * is looked up without the mutex and dropped when add_metric() bumps the
+ * generation. Values are per-metric atomics, so recording takes the mutex
+ * only to resolve a new call site. The mutex orders registrations against
+ * resolving, snapshots and resets.
+ */
+class MetricsAggregator {
+public:
+    // arg_index of the last extracted value
+    static constexpr size_t LAST_ARG = SIZE_MAX - 1;
+
+    /**
+     * @brief Count messages of matching call sites
+     * @param name Metric name
+     * @param pattern Shell glob matched against the format string
+     * @param drop_text Also remove matching lines from the text output
+     */
+    void add_counter(const std::string& name, const std::string& pattern, bool drop_text = false) {
+        add_metric(std::make_unique<Metric>(name, pattern, SIZE_MAX, std::vector<double>{}, drop_text));
+    }
+
+    /**
+     * @brief Build a histogram of one numeric argument of matching call sites
+     * @param name Metric name
+     * @param pattern Shell glob matched against the format string
+     * @param arg_index Index of the observed argument (0 = first), or LAST_ARG
+     *                  (the duration in ns for LOG_SCOPE_TIMER entries)
+     * @param bounds Bucket upper bounds (sorted here)
+     * @param drop_text Also remove matching lines from the text output
+     */
+    void add_histogram(const std::string& name, const std::string& pattern, size_t arg_index,
+                       std::vector<double> bounds, bool drop_text = false) {
+        std::sort(bounds.begin(), bounds.end());
+        add_metric(std::make_unique<Metric>(name, pattern, arg_index, std::move(bounds), drop_text));
+    }
+
+    /**
+     * @brief Account one message (backend thread)
+     * @param decoder Metadata::decoder of the message
+     * @param args Encoded arguments
+     * @return true if the message's text line should be dropped
+     */
+    bool record(DecoderFunc decoder, const std::byte* args) {
+        uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (generation != bound_generation_) [[unlikely]] {
+            bindings_.clear();  // Re-resolve call sites against the new metrics
+            bound_generation_ = generation;
+        }
+        auto it = bindings_.find(decoder);
+        if (it == bindings_.end()) [[unlikely]] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            it = bindings_.emplace(decoder, bind(decoder)).first;
+        }
+        const Binding& binding = it->second;
+        if (binding.metrics.empty()) {
+            return false;
+        }
+
+        ArgValue values[MAX_ARGS];
+        size_t value_count = 0;
+        if (binding.needs_args && binding.extract != nullptr && args != nullptr) {
+            value_count = binding.extract(args, values, MAX_ARGS);
+        }
+
+        for (Metric* metric_ptr : binding.metrics) {
+            Metric& metric = *metric_ptr;
+            metric.count.fetch_add(1, std::memory_order_relaxed);
+            if (metric.arg_index == SIZE_MAX) {
+                continue;
+            }
+            size_t arg = (metric.arg_index == LAST_ARG && value_count > 0) ? value_count - 1 : metric.arg_index;
+            if (arg >= value_count ||
+                values[arg].type == ArgValue::Type::STRING ||
+                values[arg].type == ArgValue::Type::NONE) {
+                continue;  // Not a numeric argument: counted only
+            }
+            metric.observe(values[arg].as_double());
+        }
+        return binding.drop_text;
+    }
+
+    /**
+     * @brief Get the current values of all metrics
+     */
+    std::vector<MetricSnapshot> snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<MetricSnapshot> result;
+        result.reserve(metrics_.size());
+        for (const auto& metric : metrics_) {
+            bool observed = metric->observed.load(std::memory_order_relaxed) > 0;
+            std::vector<uint64_t> buckets;
+            buckets.reserve(metric->buckets.size());
+            for (const auto& bucket : metric->buckets) {
+                buckets.push_back(bucket.load(std::memory_order_relaxed));
+            }
+            result.push_back(MetricSnapshot{metric->name, metric->pattern,
+                                            metric->count.load(std::memory_order_relaxed),
+                                            metric->sum.load(std::memory_order_relaxed),
+                                            observed ? metric->min.load(std::memory_order_relaxed) : 0.0,
+                                            observed ? metric->max.load(std::memory_order_relaxed) : 0.0,
+                                            metric->bounds, std::move(buckets)});
+        }
+        return result;
+    }
+
+    /**
+     * @brief Zero all values (registrations are kept)
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& metric : metrics_) {
+            metric->clear();
+        }
+    }
+
+    /**
+     * @brief Check if any metric is registered
+     */
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return metrics_.empty();
+    }
+
+private:
+    static constexpr size_t MAX_ARGS = 16;  // Arguments past this index cannot be observed
+
+    // Registration (immutable) and values (written by the backend thread, zeroed by reset())
+    struct Metric {
+        Metric(std::string name_, std::string pattern_, size_t arg_index_, std::vector<double> bounds_, bool drop_text_)
+            : name(std::move(name_)), pattern(std::move(pattern_)), arg_index(arg_index_),
+              bounds(std::move(bounds_)), drop_text(drop_text_),
+              buckets(arg_index == SIZE_MAX ? 0 : bounds.size() + 1) {}
+
+        std::string name;
+        std::string pattern;
+        size_t arg_index;                   // SIZE_MAX: counter
+        std::vector<double> bounds;
+        bool drop_text;
+        std::vector<std::atomic<uint64_t>> buckets;
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> observed{0};
+        std::atomic<double> sum{0.0};
+        std::atomic<double> min{std::numeric_limits<double>::max()};
+        std::atomic<double> max{std::numeric_limits<double>::lowest()};
+
+        void observe(double value) {
+            size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+            buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            observed.fetch_add(1, std::memory_order_relaxed);
+            sum.fetch_add(value, std::memory_order_relaxed);
+            // Compare-exchange so a concurrent reset() is not overwritten
+            double current = min.load(std::memory_order_relaxed);
+            while (value < current && !min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+            }
+            current = max.load(std::memory_order_relaxed);
+            while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        void clear() {
+            for (auto& bucket : buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            count.store(0, std::memory_order_relaxed);
+            observed.store(0, std::memory_order_relaxed);
+            sum.store(0.0, std::memory_order_relaxed);
+            min.store(std::numeric_limits<double>::max(), std::memory_order_relaxed);
+            max.store(std::numeric_limits<double>::lowest(), std::memory_order_relaxed);
+        }
+    };
+
+    struct Binding {
+        std::vector<Metric*> metrics;       // Owned by metrics_, never removed
+        ArgExtractor extract{nullptr};
+        bool needs_args{false};             // At least one histogram
+        bool drop_text{false};              // Any matching metric drops the line
+    };
+
+    void add_metric(std::unique_ptr<Metric> metric) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        metrics_.push_back(std::move(metric));
+        generation_.fetch_add(1, std::memory_order_release);  // Backend drops its bindings
+    }
+
+    /**
+     * @brief Find the metrics attached to a decoder (mutex held)
+     */
+    Binding bind(DecoderFunc decoder) const {
+        Binding binding;
+        DecoderInfo info = DecoderRegistry::instance().find(decoder);
+        if (info.format.empty()) {
+            return binding;
+        }
+        binding.extract = info.extract;
+        std::string format(info.format);
+        for (const auto& metric : metrics_) {
+            if (::fnmatch(metric->pattern.c_str(), format.c_str(), 0) == 0) {
+                binding.metrics.push_back(metric.get());
+                binding.needs_args |= metric->arg_index != SIZE_MAX;
+                binding.drop_text |= metric->drop_text;
+            }
+        }
+        return binding;
+    }
+
+    mutable std::mutex mutex_;                               // Registrations vs. resolving, snapshots, resets
+    std::vector<std::unique_ptr<Metric>> metrics_;           // Stable addresses for the bindings
+    std::atomic<uint64_t> generation_{0};                    // Bumped by every add_metric()
+    uint64_t bound_generation_{0};                           // Backend thread: generation of bindings_
+    std::unordered_map<DecoderFunc, Binding> bindings_;      // Backend thread only
+};
+
+} // namespace logZ
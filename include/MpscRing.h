@@ -0,0 +1,220 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace logZ {
+
+/**
+ * @brief Lock-free multi-producer single-consumer ring buffer for bytes
+ *
+ * Shared by transient threads (threads that log a few times and exit), so they
+ * don't allocate and register a per-thread Queue that is orphaned right away.
+ *
+ * Record layout (8-byte aligned, never wraps around the buffer end):
+ * - RecordHeader: state (EMPTY / COMMITTED / PADDING) + total record size
+ * - payload
+ *
+ * Protocol:
+ * - Producers reserve by advancing write_pos_ (CAS, so a full ring rejects the
+ *   write instead of overrunning unread data), fill the payload, then publish
+ *   the record by storing its state flag (release)
+ * - The consumer reads records in order and stops at the first record whose
+ *   flag is not set yet, so a slow producer only delays records behind it
+ * - The consumer zeroes consumed records before releasing them, so a
+ *   reserved-but-unwritten header always reads as EMPTY
+ *
+ * The read()/commit_read() interface mirrors Queue so Backend can process
+ * both with the same code.
+ */
+class alignas(64) MpscRing {
+private:
+    struct RecordHeader {
+        std::atomic<uint32_t> state;   // Publication flag, written last by the producer
+        uint32_t size;                 // Total record size including header
+    };
+
+    static constexpr uint32_t STATE_EMPTY = 0;
+    static constexpr uint32_t STATE_COMMITTED = 1;
+    static constexpr uint32_t STATE_PADDING = 2;
+    static constexpr size_t ALIGNMENT = 8;
+
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Capacity in bytes (rounded up to a power of 2)
+     */
+    explicit MpscRing(size_t capacity)
+        : capacity_(next_power_of_2(capacity < 64 ? 64 : capacity))
+        , capacity_mask_(capacity_ - 1)
+        , write_pos_(0)
+        , read_pos_(0)
+        , buffer_(std::make_unique<std::byte[]>(capacity_)) {
+        // Zero-fill: unwritten headers must read as EMPTY (also pre-faults pages)
+        std::memset(buffer_.get(), 0, capacity_);
+    }
+
+    ~MpscRing() = default;
+
+    // Disable copy and move
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+    MpscRing(MpscRing&&) = delete;
+    MpscRing& operator=(MpscRing&&) = delete;
+
+    /**
+     * @brief Reserve a record (any producer thread)
+     * @param size Payload size in bytes
+     * @return Pointer to the payload, or nullptr if the ring is full
+     *
+     * IMPORTANT: Must call commit_write() with the returned pointer.
+     */
+    std::byte* reserve_write(size_t size) {
+        size_t total = align_up(sizeof(RecordHeader) + size);
+        if (size == 0 || total > capacity_ / 2) [[unlikely]] {
+            return nullptr;
+        }
+
+        uint64_t current_write = write_pos_.load(std::memory_order_relaxed);
+        size_t padding;
+        do {
+            uint64_t current_read = read_pos_.load(std::memory_order_acquire);
+            size_t pos = current_write & capacity_mask_;
+            // Records never wrap: pad to the end of the buffer if needed
+            padding = (pos + total > capacity_) ? capacity_ - pos : 0;
+            if (current_write + padding + total - current_read > capacity_) {
+                return nullptr;  // Not enough space
+            }
+        } while (!write_pos_.compare_exchange_weak(current_write, current_write + padding + total,
+                                                   std::memory_order_relaxed,
+                                                   std::memory_order_relaxed));
+
+        if (padding > 0) {
+            auto* pad = header_at(current_write);
+            pad->size = static_cast<uint32_t>(padding);
+            pad->state.store(STATE_PADDING, std::memory_order_release);
+            current_write += padding;
+        }
+
+        auto* header = header_at(current_write);
+        header->size = static_cast<uint32_t>(total);
+        return reinterpret_cast<std::byte*>(header) + sizeof(RecordHeader);
+    }
+
+    /**
+     * @brief Publish a record reserved with reserve_write()
+     * @param payload Pointer returned by reserve_write()
+     */
+    void commit_write(std::byte* payload) {
+        auto* header = reinterpret_cast<RecordHeader*>(payload - sizeof(RecordHeader));
+        header->state.store(STATE_COMMITTED, std::memory_order_release);
+    }
+
+    /**
+     * @brief Peek at the oldest published record (consumer only)
+     * @param size Number of bytes needed from the payload
+     * @return Pointer to the payload, or nullptr if no published record is available
+     */
+    std::byte* read(size_t size) {
+        if (size == 0) {
+            return nullptr;
+        }
+
+        RecordHeader* header = head_record();
+        if (header == nullptr) {
+            return nullptr;
+        }
+        if (size > header->size - sizeof(RecordHeader)) {
+            return nullptr;
+        }
+        return reinterpret_cast<std::byte*>(header) + sizeof(RecordHeader);
+    }
+
+    /**
+     * @brief Release the record returned by read() (consumer only)
+     * @param size Ignored: the whole record is released (kept for Queue compatibility)
+     */
+    void commit_read(size_t /*size*/) {
+        RecordHeader* header = head_record();
+        if (header != nullptr) {
+            release_record(header);
+        }
+    }
+
+    /**
+     * @brief Check if no record is reserved or published
+     */
+    bool is_empty() const {
+        return write_pos_.load(std::memory_order_acquire) == read_pos_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the capacity of the ring
+     */
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    /**
+     * @brief Find the oldest published record, releasing padding on the way
+     */
+    RecordHeader* head_record() {
+        while (true) {
+            uint64_t current_read = read_pos_.load(std::memory_order_relaxed);
+            if (current_read == write_pos_.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            RecordHeader* header = header_at(current_read);
+            uint32_t state = header->state.load(std::memory_order_acquire);
+            if (state == STATE_COMMITTED) {
+                return header;
+            }
+            if (state != STATE_PADDING) {
+                return nullptr;  // Reserved but not published yet
+            }
+            release_record(header);
+        }
+    }
+
+    /**
+     * @brief Zero a consumed record and hand its space back to producers
+     */
+    void release_record(RecordHeader* header) {
+        uint32_t size = header->size;
+        std::memset(static_cast<void*>(header), 0, size);
+        uint64_t current_read = read_pos_.load(std::memory_order_relaxed);
+        read_pos_.store(current_read + size, std::memory_order_release);
+    }
+
+    RecordHeader* header_at(uint64_t position) {
+        return reinterpret_cast<RecordHeader*>(&buffer_[position & capacity_mask_]);
+    }
+
+    static constexpr size_t align_up(size_t n) {
+        return (n + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    static constexpr size_t next_power_of_2(size_t n) {
+        if (n == 0) return 1;
+        --n;
+        n |= n >> 1;
+        n |= n >> 2;
+        n |= n >> 4;
+        n |= n >> 8;
+        n |= n >> 16;
+        n |= n >> 32;
+        return n + 1;
+    }
+
+    const size_t capacity_;                      // Capacity in bytes (power of 2)
+    const size_t capacity_mask_;                 // Bit mask for fast modulo
+    alignas(64) std::atomic<uint64_t> write_pos_;   // Reservation cursor (all producers)
+    alignas(64) std::atomic<uint64_t> read_pos_;    // Consumer position
+    std::unique_ptr<std::byte[]> buffer_;        // The actual buffer
+};
+
+}  // namespace logZ
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "Queue.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sched.h>
+#include <sys/sysinfo.h>  // For get_nprocs_conf
+
+#if __has_include(<sys/rseq.h>)
+#include <sys/rseq.h>
+#endif
+
+// Compile-time frontend selection
+// 0: one SPSC Queue per thread (default)
+// 1: one Queue per CPU, shared by all threads running on that CPU
+#ifndef LOGZ_PER_CPU_QUEUES
+#define LOGZ_PER_CPU_QUEUES 0
+#endif
+
+namespace logZ {
+
+/**
+ * @brief Per-CPU producer queues
+ *
+ * Caps the number of producer queues at the number of CPUs, independent of
+ * how many threads log. Intended for processes with thousands of threads
+ * (coroutine / thread pools) where a 4KB+ queue per thread does not scale.
+ *
+ * Reservation:
+ * - The current CPU is read from the rseq area glibc registers for every
+ *   thread (one TLS load, no syscall); sched_getcpu() is the fallback
+ * - Each slot has an ownership flag taken with a single exchange; the flag
+ *   hands the slot's SPSC Queue from one producer to the next
+ *   (acquire/release), so the Queue itself stays unchanged
+ * - If a thread is preempted while owning its slot, other threads on that CPU
+ *   probe the next slots instead of waiting, so no producer ever blocks;
+ *   when every slot is owned, Logger falls back to the thread's own Queue
+ *
+ * Ownership:
+ * - Backend owns the Queues (registered like per-thread queues, never orphaned)
+ * - PerCpuQueues only holds raw Queue* per slot
+ */
+class PerCpuQueues {
+public:
+    struct alignas(64) Slot {
+        std::atomic<bool> busy{false};   // Set while a producer writes into queue
+        Queue* queue{nullptr};           // Borrowed from Backend
+    };
+
+    /**
+     * @brief Constructor
+     * @param cpu_count Number of slots (defaults to configured CPUs)
+     */
+    explicit PerCpuQueues(size_t cpu_count = configured_cpus())
+        : slot_count_(cpu_count > 0 ? cpu_count : 1)
+        , slots_(std::make_unique<Slot[]>(slot_count_)) {
+    }
+
+    // Disable copy and move
+    PerCpuQueues(const PerCpuQueues&) = delete;
+    PerCpuQueues& operator=(const PerCpuQueues&) = delete;
+    PerCpuQueues(PerCpuQueues&&) = delete;
+    PerCpuQueues& operator=(PerCpuQueues&&) = delete;
+
+    /**
+     * @brief Bind a Backend-owned queue to a slot (setup only, before logging)
+     */
+    void bind(size_t index, Queue* queue) {
+        slots_[index].queue = queue;
+    }
+
+    /**
+     * @brief Take exclusive ownership of the current CPU's slot
+     * @return Owned slot, or nullptr if every slot is currently owned
+     *
+     * Must be paired with release().
+     */
+    __attribute__((always_inline, hot))
+    Slot* acquire() {
+        size_t cpu = current_cpu();
+        if (cpu >= slot_count_) [[unlikely]] {
+            cpu %= slot_count_;
+        }
+
+        Slot* slot = &slots_[cpu];
+        // Hot path: the thread owning the slot was not preempted mid-write
+        if (!slot->busy.exchange(true, std::memory_order_acquire)) [[likely]] {
+            return slot;
+        }
+        return acquire_slow(cpu);
+    }
+
+    /**
+     * @brief Release a slot taken by acquire()
+     */
+    __attribute__((always_inline, hot))
+    void release(Slot* slot) {
+        slot->busy.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Number of slots
+     */
+    size_t size() const {
+        return slot_count_;
+    }
+
+    /**
+     * @brief Get the queue bound to a slot
+     */
+    Queue* queue(size_t index) const {
+        return slots_[index].queue;
+    }
+
+    /**
+     * @brief Get the CPU the calling thread is running on
+     */
+    __attribute__((always_inline))
+    static size_t current_cpu() {
+#ifdef __GLIBC_HAVE_KERNEL_RSEQ
+        if (__rseq_size > 0) [[likely]] {
+            const auto* rs = reinterpret_cast<const volatile struct rseq*>(
+                static_cast<const char*>(__builtin_thread_pointer()) + __rseq_offset);
+            // cpu_id is negative (as int32) until the kernel has registered the area
+            int32_t rseq_cpu = static_cast<int32_t>(rs->cpu_id);
+            if (rseq_cpu >= 0) [[likely]] {
+                return static_cast<size_t>(rseq_cpu);
+            }
+        }
+#endif
+        int cpu = sched_getcpu();
+        return cpu >= 0 ? static_cast<size_t>(cpu) : 0;
+    }
+
+    /**
+     * @brief Number of CPUs configured in the system
+     */
+    static size_t configured_cpus() {
+        int n = get_nprocs_conf();
+        return n > 0 ? static_cast<size_t>(n) : 1;
+    }
+
+private:
+    /**
+     * @brief Slow path: the current CPU's slot is owned by a preempted thread
+     */
+    __attribute__((noinline, cold))
+    Slot* acquire_slow(size_t cpu) {
+        for (size_t i = 1; i < slot_count_; ++i) {
+            Slot* slot = &slots_[(cpu + i) % slot_count_];
+            if (!slot->busy.load(std::memory_order_relaxed) &&
+                !slot->busy.exchange(true, std::memory_order_acquire)) {
+                return slot;
+            }
+        }
+        return nullptr;
+    }
+
+    const size_t slot_count_;
+    std::unique_ptr<Slot[]> slots_;
+};
+
+}  // namespace logZ
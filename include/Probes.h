@@ -0,0 +1,40 @@
+#pragma once
+
+// USDT (user statically-defined tracing) probes, provider "logz"
+//
+// Each probe compiles to a single NOP plus an ELF note; attaching a tracer
+// patches the NOP, so there is no cost when nothing is attached:
+//
+//   bpftrace -e 'usdt:./app:logz:queue_grow { printf("%d -> %d\n", arg0, arg1); }'
+//
+// Probes (arguments):
+//   queue_grow(old_capacity, new_capacity)    Queue::reserve_write_slow() allocated a node
+//   queue_full(size)                          Queue at MAX_NODE_CAPACITY rejected a write
+//   drop(level, size)                         Logger dropped an entry: its queue, the shared
+//                                             ring or its CPU queue was full (level -1: a
+//                                             CONTEXT record, retried before the next entry)
+//   quota_reject(level, size)                 Logger dropped an entry (byte quota)
+//   queue_register(queue, os_tid)             Backend registered a thread's queue
+//   queue_orphan(queue)                       Thread exited, its queue awaits draining
+//   rotate(counter)                           Sinker opened the next file (size limit, or
+//                                             counter 1 of a new day)
+//   flush_start(bytes) / flush_done(bytes)    Backend::flush_to_disk()
+//   fsync_start(fd) / fsync_done(fd)          Sinker::flush() around fdatasync
+//
+// LOGZ_USDT defaults to 1 when <sys/sdt.h> (systemtap-sdt-dev) is available.
+#ifndef LOGZ_USDT
+#if __has_include(<sys/sdt.h>)
+#define LOGZ_USDT 1
+#else
+#define LOGZ_USDT 0
+#endif
+#endif
+
+#if LOGZ_USDT
+#include <sys/sdt.h>
+#define LOGZ_PROBE1(name, a) DTRACE_PROBE1(logz, name, a)
+#define LOGZ_PROBE2(name, a, b) DTRACE_PROBE2(logz, name, a, b)
+#else
+#define LOGZ_PROBE1(name, a) do { (void)sizeof(a); } while (0)
+#define LOGZ_PROBE2(name, a, b) do { (void)sizeof(a); (void)sizeof(b); } while (0)
+#endif
@@ -1,18 +1,83 @@
 #pragma once
 
 #include "RingBytes.h"
+#include "LogTypes.h"
+#include "Probes.h"
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <cstddef>
+#include <string>
 
 namespace logZ {
 
+namespace detail {
+// Nonzero while the calling thread grows a Queue: AllocCounter reports these
+// allocations apart (AllocReport::queue_growth_allocations)
+inline constinit thread_local uint32_t queue_growth_depth = 0;
+} // namespace detail
+
+/**
+ * @brief Producer-side token bucket limiting the bytes a queue accepts per second
+ * 
+ * The limit is set from any thread (Backend::set_thread_quota()) and read
+ * with relaxed loads; the bucket itself is producer-local and refilled from
+ * the entry's TSC, so admitting an entry costs no atomic read-modify-write.
+ */
+struct ByteQuota {
+    std::atomic<uint64_t> bytes_per_sec{0};  // Limit (0: unlimited)
+    std::atomic<uint64_t> burst_bytes{0};    // Bucket size
+
+    // Producer only (own cache line: the backend never touches it)
+    alignas(64) double tokens{0};
+    double bytes_per_tick{0};
+    uint64_t last_tsc{0};
+    uint64_t applied_rate{0};                // bytes_per_sec the bucket was set up for
+
+    // Entries over quota (producer stores, backend reads): own cache line, so the
+    // backend's once-per-second read does not pull the bucket away from the producer
+    alignas(64) std::atomic<uint64_t> rejected{0};
+
+    __attribute__((always_inline))
+    bool limited() const {
+        return bytes_per_sec.load(std::memory_order_relaxed) != 0;
+    }
+
+    /**
+     * @brief Take size bytes from the bucket (producer thread)
+     * @return false if over quota (counted in rejected)
+     */
+    bool admit(size_t size, uint64_t tsc) {
+        uint64_t rate = bytes_per_sec.load(std::memory_order_relaxed);
+        double burst = static_cast<double>(burst_bytes.load(std::memory_order_relaxed));
+        if (rate != applied_rate) {
+            // New limit: start with a full bucket
+            applied_rate = rate;
+            bytes_per_tick = static_cast<double>(rate) * TscCalibration::instance().tsc_to_ns_ratio / 1e9;
+            tokens = burst;
+        } else if (tsc > last_tsc) {
+            tokens = std::min(burst, tokens + static_cast<double>(tsc - last_tsc) * bytes_per_tick);
+        }
+        last_tsc = tsc;
+
+        if (tokens < static_cast<double>(size)) {
+            rejected.store(rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        tokens -= static_cast<double>(size);
+        return true;
+    }
+};
+
 /**
  * @brief A queue that manages multiple RingBytes in a linked list
  * 
  * When a RingBytes becomes full, a new one with double the size is automatically created.
  * The producer writes to the newest RingBytes, while the consumer reads from the oldest.
  * Old RingBytes are destroyed after the consumer finishes reading them.
+ * 
+ * With a ring file prefix every RingBytes is backed by its own file
+ * "<prefix>.<n>.ring" (see RingBytes), so unconsumed entries survive a crash.
  */
 class Queue {
 private:
@@ -22,8 +87,8 @@ private:
         std::atomic<Node*> next;
         size_t capacity;
         
-        explicit Node(size_t cap)
-            : ring(std::make_unique<RingBytes>(cap))
+        Node(size_t cap, std::string path)
+            : ring(std::make_unique<RingBytes>(cap, std::move(path)))
             , next(nullptr)
             , capacity(cap) {
         }
@@ -36,13 +101,15 @@ public:
     /**
      * @brief Constructor
      * @param initial_capacity Initial capacity of the first RingBytes
+     * @param ring_file_prefix Back the rings with files "<prefix>.<n>.ring" (empty: heap)
      */
-    explicit Queue(size_t initial_capacity = 4096)
+    explicit Queue(size_t initial_capacity = 4096, std::string ring_file_prefix = {})
         : write_node_(nullptr)
         , read_node_(nullptr)
-        , write_ring_(nullptr) {
+        , write_ring_(nullptr)
+        , ring_file_prefix_(std::move(ring_file_prefix)) {
         // Create the first node
-        Node* first_node = new Node(initial_capacity);
+        Node* first_node = new Node(initial_capacity, next_ring_path());
         write_node_ = first_node;
         read_node_ = first_node;
         write_ring_ = first_node->ring.get();  // 缓存 RingBytes 指针，避免间接访问
@@ -91,6 +158,16 @@ public:
     }
     
 private:
+    /**
+     * @brief File for the next node (empty for heap rings; producer side)
+     */
+    std::string next_ring_path() {
+        if (ring_file_prefix_.empty()) {
+            return {};
+        }
+        return ring_file_prefix_ + "." + std::to_string(ring_file_count_++) + ".ring";
+    }
+
     /**
      * @brief Slow path for reserve_write when current RingBytes is full
      */
@@ -100,6 +177,7 @@ private:
         
         // If already at max capacity (64MB), reject the write (drop message)
         if (current_write->capacity >= MAX_NODE_CAPACITY) [[unlikely]] {
+            LOGZ_PROBE1(queue_full, size);
             return nullptr;  // Drop message when at max capacity
         }
         
@@ -122,7 +200,10 @@ private:
             return nullptr;
         }
         
-        Node* new_node = new Node(new_capacity);
+        ++detail::queue_growth_depth;
+        Node* new_node = new Node(new_capacity, next_ring_path());
+        --detail::queue_growth_depth;
+        LOGZ_PROBE2(queue_grow, current_write->capacity, new_capacity);
         
         // Try to reserve in the new node
         std::byte* ptr = new_node->ring->reserve_write(size);
@@ -262,6 +343,33 @@ public:
         return current_write->capacity;
     }
 
+    /**
+     * @brief Byte-rate quota of this queue (checked by the producer, see Logger::log_impl)
+     */
+    ByteQuota& quota() {
+        return quota_;
+    }
+
+    /**
+     * @brief Get the capacity of all RingBytes nodes in the queue (consumer side)
+     * @return Bytes of ring memory
+     */
+    size_t memory_bytes() const {
+        size_t total = 0;
+        Node* current = read_node_;
+        Node* write = write_node_;
+        
+        while (current != nullptr) {
+            total += current->capacity;
+            if (current == write) {
+                break;
+            }
+            current = current->next.load(std::memory_order_acquire);
+        }
+        
+        return total;
+    }
+
     /**
      * @brief Get the number of RingBytes nodes in the queue
      * @return Number of nodes
@@ -285,7 +393,10 @@ public:
 private:
     alignas(64) Node* write_node_;    // Only accessed by producer thread
     alignas(64) RingBytes* write_ring_;  // 缓存当前写入的 RingBytes 指针，避免间接访问
+    ByteQuota quota_;                 // Own cache lines (ByteQuota is 64-byte aligned); limited() reads the first
     alignas(64) Node* read_node_;     // Only accessed by consumer thread
+    std::string ring_file_prefix_;    // Ring file prefix (empty: heap rings), producer side
+    size_t ring_file_count_{0};       // Ring files created so far
 };
 
 }  // namespace logZ
@@ -0,0 +1,453 @@
+#pragma once
+
+#include "LogTypes.h"
+#include "Decoder.h"
+#include "RingBytes.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace logZ {
+
+/**
+ * @brief Writes the call-site table of a persistent run directory
+ *
+ * Decoder pointers in ring entries only mean something inside the process
+ * that wrote them, so the table records, per decoder address, the format
+ * string and the wire types of its arguments (arg_type_signature), plus the
+ * TSC calibration. The file is "callsites" next to the ring files:
+ *
+ *   # logZ call sites v1
+ *   calibration <tsc_start> <ns_start> <tsc_to_ns_ratio>
+ *   <decoder address hex>\t<arg types>\t<escaped format>
+ *   ...
+ *
+ * Lines are written through to the file as decoders get registered.
+ */
+class CallSiteTable {
+public:
+    CallSiteTable() = default;
+    ~CallSiteTable() { close(); }
+
+    CallSiteTable(const CallSiteTable&) = delete;
+    CallSiteTable& operator=(const CallSiteTable&) = delete;
+
+    /**
+     * @brief Create the table and start recording all (present and future) decoders
+     * @return false if the file cannot be created
+     */
+    bool open(const std::string& path) {
+        close();
+        file_ = std::fopen(path.c_str(), "w");
+        if (file_ == nullptr) {
+            return false;
+        }
+        const auto& cal = TscCalibration::instance();
+        std::fprintf(file_, "# logZ call sites v1\ncalibration %" PRIu64 " %" PRIu64 " %.17g\n",
+                     cal.tsc_start, cal.ns_start, cal.tsc_to_ns_ratio);
+        DecoderRegistry::instance().set_listener(&CallSiteTable::on_decoder, this);
+        return true;
+    }
+
+    /**
+     * @brief Stop recording and close the file (the file stays)
+     */
+    void close() {
+        if (file_ != nullptr) {
+            DecoderRegistry::instance().set_listener(nullptr, nullptr);
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    static std::string escape(std::string_view text) {
+        std::string result;
+        for (char c : text) {
+            switch (c) {
+                case '\\': result += "\\\\"; break;
+                case '\t': result += "\\t"; break;
+                case '\n': result += "\\n"; break;
+                default:   result += c;
+            }
+        }
+        return result;
+    }
+
+    static std::string unescape(std::string_view text) {
+        std::string result;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '\\' && i + 1 < text.size()) {
+                char c = text[++i];
+                result += (c == 't') ? '\t' : (c == 'n') ? '\n' : c;
+            } else {
+                result += text[i];
+            }
+        }
+        return result;
+    }
+
+private:
+    // Called under the DecoderRegistry lock
+    static void on_decoder(const DecoderInfo& info, void* context) {
+        std::FILE* file = static_cast<CallSiteTable*>(context)->file_;
+        std::fprintf(file, "%" PRIxPTR "\t%.*s\t%s\n", reinterpret_cast<uintptr_t>(info.decoder),
+                     static_cast<int>(info.arg_types.size()), info.arg_types.data(),
+                     escape(info.format).c_str());
+        std::fflush(file);
+    }
+
+    std::FILE* file_{nullptr};
+};
+
+/**
+ * @brief One LOG entry read back from the ring files of a crashed process
+ */
+struct RecoveredEntry {
+    uint64_t timestamp_ns;
+    LogLevel level;
+    std::string queue;         // Ring file prefix ("queue-3")
+    std::string text;          // "[INFO] HH:MM:SS:sss message"
+};
+
+/**
+ * @brief Reads a persistent run directory ("<run_dir>/<pid>") after a crash
+ *
+ * Walks [read_pos, write_pos) of every ring file, i.e. what the backend had
+ * not consumed, and renders LOG entries from the call-site table. Formatting
+ * is positional: each "{...}" takes the next argument with default
+ * formatting; string literals passed as FixedString arguments point into the
+ * dead process and print as "<literal>".
+ */
+class RecoveryReader {
+public:
+    /**
+     * @brief Recover all unconsumed entries of a run directory, oldest first
+     * @param error Set to a message when the directory cannot be read
+     * @param warnings Receives one message per skipped file or call-site line
+     *                 (stray file names, corrupt lines); may be nullptr
+     */
+    static std::vector<RecoveredEntry> recover(const std::string& dir, std::string* error = nullptr,
+                                               std::vector<std::string>* warnings = nullptr) {
+        RecoveryReader reader;
+        std::vector<RecoveredEntry> entries;
+        if (!reader.load_call_sites(dir + "/callsites")) {
+            if (error != nullptr) {
+                *error = "cannot read " + dir + "/callsites";
+            }
+            return entries;
+        }
+
+        // queue-N.<node>.ring
+        struct Ring {
+            std::string queue;
+            uint64_t node;
+            std::filesystem::path path;
+        };
+        std::vector<Ring> rings;
+        std::error_code ec;
+        for (const auto& file : std::filesystem::directory_iterator(dir, ec)) {
+            if (file.path().extension() != ".ring") {
+                continue;
+            }
+            std::string stem = file.path().stem().string();
+            size_t dot = stem.rfind('.');
+            uint64_t node = 0;
+            if (dot == std::string::npos || dot == 0 || !parse_number(std::string_view(stem).substr(dot + 1), node)) {
+                reader.warnings_.push_back("skipped " + file.path().filename().string() + ": not <queue>.<node>.ring");
+                continue;
+            }
+            rings.push_back({stem.substr(0, dot), node, file.path()});
+        }
+        // Nodes of one queue in order
+        std::sort(rings.begin(), rings.end(), [](const Ring& a, const Ring& b) {
+            return std::tie(a.queue, a.node) < std::tie(b.queue, b.node);
+        });
+
+        std::vector<std::pair<std::string, std::vector<RecoveredEntry>>> per_queue;
+        for (const auto& ring : rings) {
+            if (per_queue.empty() || per_queue.back().first != ring.queue) {
+                per_queue.emplace_back(ring.queue, std::vector<RecoveredEntry>{});
+                reader.context_.clear();
+            }
+            reader.read_ring(ring.path.string(), ring.queue, per_queue.back().second);
+        }
+        for (auto& [queue, queue_entries] : per_queue) {
+            entries.insert(entries.end(), std::make_move_iterator(queue_entries.begin()),
+                           std::make_move_iterator(queue_entries.end()));
+        }
+        // Each queue is already in order: a stable merge by time keeps it
+        std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+            return a.timestamp_ns < b.timestamp_ns;
+        });
+        if (warnings != nullptr) {
+            warnings->insert(warnings->end(), reader.warnings_.begin(), reader.warnings_.end());
+        }
+        return entries;
+    }
+
+private:
+    struct CallSite {
+        std::vector<std::string> arg_types;
+        std::string format;
+    };
+
+    /**
+     * @brief Parse a whole string as an unsigned number (no exceptions)
+     */
+    static bool parse_number(std::string_view text, uint64_t& value, int base = 10) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value, base);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size() && !text.empty();
+    }
+
+    bool load_call_sites(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            return false;
+        }
+        std::string line;
+        size_t line_number = 0;
+        while (std::getline(in, line)) {
+            ++line_number;
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            if (line.rfind("calibration ", 0) == 0) {
+                std::sscanf(line.c_str(), "calibration %" SCNu64 " %" SCNu64 " %lf",
+                            &tsc_start_, &ns_start_, &tsc_to_ns_ratio_);
+                continue;
+            }
+            size_t tab1 = line.find('\t');
+            size_t tab2 = line.find('\t', tab1 + 1);
+            uint64_t address = 0;
+            if (tab1 == std::string::npos || tab2 == std::string::npos ||
+                !parse_number(std::string_view(line).substr(0, tab1), address, 16)) {
+                warnings_.push_back("skipped callsites line " + std::to_string(line_number) + ": malformed");
+                continue;
+            }
+            CallSite site;
+            std::string types = line.substr(tab1 + 1, tab2 - tab1 - 1);
+            for (size_t pos = 0; pos < types.size();) {
+                size_t space = types.find(' ', pos);
+                if (space == std::string::npos) {
+                    space = types.size();
+                }
+                site.arg_types.push_back(types.substr(pos, space - pos));
+                pos = space + 1;
+            }
+            site.format = CallSiteTable::unescape(std::string_view(line).substr(tab2 + 1));
+            call_sites_[static_cast<uintptr_t>(address)] = std::move(site);
+        }
+        return true;
+    }
+
+    void read_ring(const std::string& path, const std::string& queue, std::vector<RecoveredEntry>& out) {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (file.size() < sizeof(RingHeader)) {
+            return;
+        }
+        uint64_t magic, capacity, write_pos, read_pos;
+        std::memcpy(&magic, file.data() + offsetof(RingHeader, magic), sizeof(uint64_t));
+        std::memcpy(&capacity, file.data() + offsetof(RingHeader, capacity), sizeof(uint64_t));
+        std::memcpy(&write_pos, file.data() + offsetof(RingHeader, write_pos), sizeof(uint64_t));
+        std::memcpy(&read_pos, file.data() + offsetof(RingHeader, read_pos), sizeof(uint64_t));
+        if (magic != RingHeader::MAGIC || file.size() < sizeof(RingHeader) + capacity ||
+            write_pos < read_pos || write_pos - read_pos > capacity) {
+            return;
+        }
+        const std::byte* data = reinterpret_cast<const std::byte*>(file.data() + sizeof(RingHeader));
+
+        for (uint64_t pos = read_pos; pos + sizeof(Metadata) <= write_pos;) {
+            size_t offset = pos & (capacity - 1);
+            if (offset + sizeof(Metadata) > capacity) {
+                break;
+            }
+            Metadata meta;
+            std::memcpy(&meta, data + offset, sizeof(Metadata));
+            size_t total = sizeof(Metadata) + meta.args_size;
+            if (offset + total > capacity || pos + total > write_pos) {
+                break;  // Torn or corrupt entry
+            }
+            const std::byte* args = data + offset + sizeof(Metadata);
+            if (meta.kind == EntryKind::CONTEXT) {
+                context_ = std::string(DecodedValue<std::string_view>::decode_impl(args).first);
+            } else if (meta.kind == EntryKind::LOG) {
+                RecoveredEntry entry = render(meta, args, queue);
+                if (meta.dropped_before != 0) {
+                    RecoveredEntry marker{entry.timestamp_ns, LogLevel::WARN, queue, {}};
+                    marker.text = "[WARN] " + std::to_string(meta.dropped_before) + " messages dropped on " + queue;
+                    out.push_back(std::move(marker));
+                }
+                out.push_back(std::move(entry));
+            }
+            pos += total;
+        }
+    }
+
+    RecoveredEntry render(const Metadata& meta, const std::byte* args, const std::string& queue) const {
+        RecoveredEntry entry;
+        entry.level = meta.level;
+        entry.queue = queue;
+        int64_t tsc_diff = static_cast<int64_t>(meta.timestamp - tsc_start_);
+        entry.timestamp_ns = ns_start_ + static_cast<uint64_t>(tsc_diff * tsc_to_ns_ratio_);
+
+        static constexpr const char* levels[] = {"[TRACE]", "[DEBUG]", "[INFO]", "[WARN]", "[ERROR]", "[FATAL]"};
+        uint64_t ms = entry.timestamp_ns / 1000000;
+        uint64_t s = ms / 1000 % 86400;
+        char head[48];
+        std::snprintf(head, sizeof(head), "%s %02u:%02u:%02u:%03u ",
+                      static_cast<size_t>(meta.level) < 6 ? levels[static_cast<size_t>(meta.level)] : "[UNKNOWN]",
+                      static_cast<unsigned>(s / 3600), static_cast<unsigned>(s / 60 % 60),
+                      static_cast<unsigned>(s % 60), static_cast<unsigned>(ms % 1000));
+        entry.text = head;
+        entry.text += context_;
+
+        auto it = call_sites_.find(reinterpret_cast<uintptr_t>(meta.decoder));
+        if (it == call_sites_.end()) {
+            char unknown[48];
+            std::snprintf(unknown, sizeof(unknown), "<unknown call site %p>", reinterpret_cast<void*>(meta.decoder));
+            entry.text += unknown;
+            return entry;
+        }
+
+        const CallSite& site = it->second;
+        const std::byte* ptr = args;
+        const std::byte* end = args + meta.args_size;
+        std::vector<std::string> values;
+        std::string took;
+        for (const auto& type : site.arg_types) {
+            if (type == "t") {
+                if (static_cast<size_t>(end - ptr) < sizeof(ScopeTiming)) {
+                    ptr = end;  // Short entry: nothing left to read for the remaining arguments
+                    continue;
+                }
+                ScopeTiming timing;
+                std::memcpy(&timing, ptr, sizeof(ScopeTiming));
+                ptr += sizeof(ScopeTiming);
+                uint64_t ticks = timing.end_tsc > timing.start_tsc ? timing.end_tsc - timing.start_tsc : 0;
+                took = " took " + std::to_string(static_cast<uint64_t>(ticks * tsc_to_ns_ratio_)) + "ns";
+            } else {
+                values.push_back(render_arg(type, ptr, end));
+            }
+        }
+
+        // Positional substitution: "{...}" -> next value, "{{" / "}}" -> brace
+        const std::string& fmt = site.format;
+        size_t next = 0;
+        for (size_t i = 0; i < fmt.size(); ++i) {
+            if ((fmt[i] == '{' || fmt[i] == '}') && i + 1 < fmt.size() && fmt[i + 1] == fmt[i]) {
+                entry.text += fmt[i++];
+            } else if (fmt[i] == '{') {
+                size_t close = fmt.find('}', i);
+                if (close == std::string::npos) {
+                    entry.text += fmt.substr(i);
+                    break;
+                }
+                entry.text += next < values.size() ? values[next++] : std::string("{}");
+                i = close;
+            } else {
+                entry.text += fmt[i];
+            }
+        }
+        entry.text += took;
+        return entry;
+    }
+
+    // Render one argument of the given wire type and advance ptr (see arg_type_token)
+    static std::string render_arg(const std::string& type, const std::byte*& ptr, const std::byte* end) {
+        uint64_t size = 0;
+        if (type.empty() || (type.size() > 1 && !parse_number(std::string_view(type).substr(1), size))) {
+            ptr = end;  // Unknown layout: the remaining arguments cannot be located
+            return "<bad type " + type + ">";
+        }
+        auto read = [&](void* dst, size_t n) {
+            if (ptr + n > end) {
+                ptr = end;
+                return false;
+            }
+            std::memcpy(dst, ptr, n);
+            ptr += n;
+            return true;
+        };
+
+        char buf[64];
+        switch (type[0]) {
+            case 'b': { bool v = false; read(&v, 1); return v ? "true" : "false"; }
+            case 'c': { char v = 0; read(&v, 1); return std::string(1, v); }
+            case 'i': {
+                int64_t v = 0;
+                if (size == 1) { int8_t x = 0; read(&x, 1); v = x; }
+                else if (size == 2) { int16_t x = 0; read(&x, 2); v = x; }
+                else if (size == 4) { int32_t x = 0; read(&x, 4); v = x; }
+                else { read(&v, 8); }
+                return std::to_string(v);
+            }
+            case 'u': {
+                uint64_t v = 0;
+                read(&v, std::min<size_t>(size, 8));
+                return std::to_string(v);
+            }
+            case 'f': {
+                double v = 0;
+                if (size == 4) { float x = 0; read(&x, 4); v = x; } else { read(&v, 8); }
+                auto result = std::to_chars(buf, buf + sizeof(buf), v);
+                return std::string(buf, result.ptr);
+            }
+            case 's': {
+                unsigned short len = 0;
+                read(&len, sizeof(len));
+                len = static_cast<unsigned short>(std::min<size_t>(len, end - ptr));
+                std::string v(reinterpret_cast<const char*>(ptr), len);
+                ptr += len;
+                return v;
+            }
+            case 'L': {
+                ptr = std::min(ptr + sizeof(unsigned short) + sizeof(const char*), end);
+                return "<literal>";
+            }
+            case 'T': {
+                uint16_t depth = 0;
+                read(&depth, sizeof(depth));
+                std::string v;
+                for (uint16_t i = 0; i < depth; ++i) {
+                    void* frame = nullptr;
+                    if (!read(&frame, sizeof(frame))) {
+                        break;
+                    }
+                    std::snprintf(buf, sizeof(buf), "\n    #%u %p", static_cast<unsigned>(i), frame);
+                    v += buf;
+                }
+                return v;
+            }
+            case 'n': {
+                ErrnoValue v{};
+                read(&v, sizeof(v));
+                return std::string(std::strerror(v.code)) + " (" + std::to_string(v.code) + ")";
+            }
+            default: {
+                std::string v = "<" + std::to_string(size) + " bytes>";
+                ptr = size < static_cast<uint64_t>(end - ptr) ? ptr + size : end;
+                return v;
+            }
+        }
+    }
+
+    std::unordered_map<uintptr_t, CallSite> call_sites_;
+    uint64_t tsc_start_{0};
+    uint64_t ns_start_{0};
+    double tsc_to_ns_ratio_{1.0};
+    std::string context_;      // Current ScopedContext of the queue being read
+    std::vector<std::string> warnings_;
+};
+
+} // namespace logZ
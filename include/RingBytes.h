@@ -4,10 +4,32 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
-#include <memory>
+#include <new>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace logZ {
 
+/**
+ * @brief Header in front of the ring data (heap block or mapped ring file)
+ * 
+ * File-backed rings are MAP_SHARED, so the header and the data survive a
+ * crash in the page cache: [read_pos, write_pos) are the entries the
+ * backend had not consumed yet (see Recovery.h). The layout is the file format.
+ */
+struct RingHeader {
+    static constexpr uint64_t MAGIC = 0x31474E525A474F4CULL;  // "LOGZRNG1"
+
+    uint64_t magic;
+    uint64_t capacity;                                  // Data bytes after the header
+    alignas(64) std::atomic<uint64_t> write_pos;        // Write position (visible to readers after commit)
+    alignas(64) std::atomic<uint64_t> read_pos;         // Current read position
+};
+
+static_assert(sizeof(RingHeader) == 192, "RingHeader is the ring file format");
+
 /**
  * @brief Lock-free ring buffer for bytes, supporting single producer single consumer (SPSC)
  * 
@@ -15,6 +37,10 @@ namespace logZ {
  * It supports lock-free operations for one writer and one reader.
  * 
  * Cache line alignment: Hot data members are aligned to prevent false sharing
+ * 
+ * Storage is one block: RingHeader (positions) followed by the data. It is
+ * either heap memory or, with a file path, a MAP_SHARED mapping of that file;
+ * reserve/commit are the same code for both.
  */
 class alignas(64) RingBytes {
 public:
@@ -23,11 +49,29 @@ public:
      * @param capacity The capacity of the ring buffer (must be power of 2 for better performance)
      */
     explicit RingBytes(size_t capacity)
+        : RingBytes(capacity, std::string()) {
+    }
+
+    /**
+     * @brief Constructor for a file-backed ring
+     * @param capacity The capacity of the ring buffer (rounded up to a power of 2)
+     * @param path Ring file, created and mapped MAP_SHARED; empty: heap memory.
+     *             Falls back to heap memory if the file cannot be mapped.
+     *             The file is removed when the ring is destroyed.
+     */
+    RingBytes(size_t capacity, std::string path)
         : capacity_(next_power_of_2(capacity))
         , capacity_mask_(capacity_ - 1)
-        , write_pos_(0)
-        , read_pos_(0)
-        , buffer_(std::make_unique<std::byte[]>(capacity_)) {
+        , path_(std::move(path)) {
+        void* block = path_.empty() ? nullptr : map_file(path_, sizeof(RingHeader) + capacity_);
+        if (block != nullptr) {
+            mapped_ = true;
+        } else {
+            path_.clear();
+            block = ::operator new(sizeof(RingHeader) + capacity_, std::align_val_t{64});
+        }
+        header_ = new (block) RingHeader{RingHeader::MAGIC, capacity_, {0}, {0}};
+        buffer_ = static_cast<std::byte*>(block) + sizeof(RingHeader);
         
         // 优化：预先触发page fault，避免运行时延迟尖刺
         // 写入每个4KB页面（4096字节）让内核分配物理内存
@@ -38,7 +82,14 @@ public:
         }
     }
 
-    ~RingBytes() = default;
+    ~RingBytes() {
+        if (mapped_) {
+            ::munmap(header_, sizeof(RingHeader) + capacity_);
+            ::unlink(path_.c_str());
+        } else {
+            ::operator delete(header_, std::align_val_t{64});
+        }
+    }
 
     // Disable copy and move
     RingBytes(const RingBytes&) = delete;
@@ -61,8 +112,8 @@ public:
      * IMPORTANT: Must call commit_write() after writing data to make it visible to readers.
      * 
      * Memory Order 优化说明 (SPSC):
-     * - write_pos_: relaxed (只有 producer 写，自己读自己写的值)
-     * - read_pos_: relaxed (只需要一个大致的值来检查空间，偶尔滞后没关系)
+     * - write_pos: relaxed (只有 producer 写，自己读自己写的值)
+     * - read_pos: relaxed (只需要一个大致的值来检查空间，偶尔滞后没关系)
      *   在 SPSC 中，如果 read_pos 稍微滞后，最坏情况是误判队列已满，
      *   这是安全的（丢弃消息），不会导致数据竞争
      */
@@ -73,8 +124,8 @@ public:
         }
 
         // Load current positions with relaxed ordering (SPSC optimization)
-        uint64_t current_write = write_pos_.load(std::memory_order_relaxed);
-        uint64_t current_read = read_pos_.load(std::memory_order_relaxed);
+        uint64_t current_write = header_->write_pos.load(std::memory_order_relaxed);
+        uint64_t current_read = header_->read_pos.load(std::memory_order_relaxed);
 
         // Calculate available space
         uint64_t available = capacity_ - (current_write - current_read);
@@ -94,7 +145,7 @@ public:
             return nullptr;  // Would wrap around, need new node
         }
 
-        // Don't move write_pos_ yet! Just return the pointer.
+        // Don't move write_pos yet! Just return the pointer.
         // The caller will write data and then call commit_write().
         return &buffer_[pos];
     }
@@ -108,8 +159,8 @@ public:
      */
     __attribute__((always_inline, hot))
     void commit_write(size_t size) {
-        uint64_t current = write_pos_.load(std::memory_order_relaxed);
-        write_pos_.store(current + size, std::memory_order_release);
+        uint64_t current = header_->write_pos.load(std::memory_order_relaxed);
+        header_->write_pos.store(current + size, std::memory_order_release);
     }
 
     /**
@@ -125,8 +176,8 @@ public:
             return nullptr;
         }
 
-        uint64_t current_read = read_pos_.load(std::memory_order_relaxed);
-        uint64_t current_write = write_pos_.load(std::memory_order_acquire);
+        uint64_t current_read = header_->read_pos.load(std::memory_order_relaxed);
+        uint64_t current_write = header_->write_pos.load(std::memory_order_acquire);
 
         // Calculate available data
         uint64_t available = current_write - current_read;
@@ -147,8 +198,8 @@ public:
      * This advances the read position and frees up space for writing.
      */
     void commit_read(size_t size) {
-        uint64_t current_read = read_pos_.load(std::memory_order_relaxed);
-        read_pos_.store(current_read + size, std::memory_order_release);
+        uint64_t current_read = header_->read_pos.load(std::memory_order_relaxed);
+        header_->read_pos.store(current_read + size, std::memory_order_release);
     }
 
     /**
@@ -159,13 +210,20 @@ public:
         return capacity_;
     }
 
+    /**
+     * @brief Ring file path (empty for heap rings)
+     */
+    const std::string& path() const {
+        return path_;
+    }
+
     /**
      * @brief Get the number of bytes available for reading
      * @return Number of bytes available
      */
     size_t available_read() const {
-        uint64_t current_read = read_pos_.load(std::memory_order_relaxed);
-        uint64_t current_write = write_pos_.load(std::memory_order_acquire);
+        uint64_t current_read = header_->read_pos.load(std::memory_order_relaxed);
+        uint64_t current_write = header_->write_pos.load(std::memory_order_acquire);
         return current_write - current_read;
     }
 
@@ -174,12 +232,33 @@ public:
      * @return Number of bytes available
      */
     size_t available_write() const {
-        uint64_t current_write = write_pos_.load(std::memory_order_relaxed);
-        uint64_t current_read = read_pos_.load(std::memory_order_acquire);
+        uint64_t current_write = header_->write_pos.load(std::memory_order_relaxed);
+        uint64_t current_read = header_->read_pos.load(std::memory_order_acquire);
         return capacity_ - (current_write - current_read);
     }
 
 private:
+    /**
+     * @brief Create, size and map a ring file
+     * @return Mapping, or nullptr on failure
+     */
+    static void* map_file(const std::string& path, size_t size) {
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return nullptr;
+        }
+        void* block = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            block = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (block == MAP_FAILED) {
+            ::unlink(path.c_str());
+            return nullptr;
+        }
+        return block;
+    }
+
     /**
      * @brief Round up to the next power of 2
      * @param n Input value
@@ -199,9 +278,10 @@ private:
 
     const size_t capacity_;                    // Fixed capacity of the buffer (power of 2)
     const size_t capacity_mask_;               // Bit mask for fast modulo (capacity - 1)
-    alignas(64) std::atomic<uint64_t> write_pos_;          // Write position (visible to readers after commit)
-    alignas(64) std::atomic<uint64_t> read_pos_;           // Current read position
-    std::unique_ptr<std::byte[]> buffer_;      // The actual buffer
+    RingHeader* header_{nullptr};              // Positions (start of the storage block)
+    std::byte* buffer_{nullptr};               // The actual buffer (right after the header)
+    std::string path_;                         // Ring file (empty: heap block)
+    bool mapped_{false};                       // Storage is a MAP_SHARED file mapping
 };
 
 }  // namespace logZ
@@ -9,6 +9,8 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include "Probes.h"
+#include "LogIndex.h"
 
 namespace logZ {
 
@@ -23,6 +25,7 @@ namespace logZ {
  * 
  * Default log directory: ./logs
  * Filename format: YYYY-MM-DD_i.log (i starts from 1)
+ * Optional sparse time index next to each file: YYYY-MM-DD_i.log.idx (see LogIndex.h)
  */
 class Sinker {
 public:
@@ -76,6 +79,11 @@ public:
             return false;
         }
 
+        // Only bytes that reached the file are indexed
+        if (index_.is_open()) [[unlikely]] {
+            index_lines(data, static_cast<size_t>(written));
+        }
+
         current_file_size_ += written;
         return written == static_cast<ssize_t>(length);
     }
@@ -86,7 +94,22 @@ public:
     void flush() {
         if (fd_ >= 0) {
             // Use fdatasync for better performance (doesn't sync metadata)
+            LOGZ_PROBE1(fsync_start, fd_);
             ::fdatasync(fd_);
+            LOGZ_PROBE1(fsync_done, fd_);
+        }
+    }
+
+    /**
+     * @brief Write a time index entry every block_bytes of log (0: disabled)
+     * Takes effect from the next line written; the current file continues
+     * its existing index, if any.
+     */
+    void enable_index(size_t block_bytes) {
+        index_block_bytes_ = block_bytes;
+        index_.close();
+        if (block_bytes != 0 && fd_ >= 0) {
+            open_index();
         }
     }
 
@@ -112,6 +135,57 @@ public:
     }
 
 private:
+    /**
+     * @brief Index the first line that starts at or after the next block boundary
+     * @param data Bytes just written at offset current_file_size_
+     * 
+     * Lines without a timestamp (stack frames) and reports are skipped; a line
+     * split across two writes is indexed from the next one. A failed index
+     * write closes the index until the next file is opened.
+     */
+    void index_lines(const std::byte* data, size_t length) {
+        const char* text = reinterpret_cast<const char*>(data);
+        bool starts_line = line_start_;
+        line_start_ = length == 0 ? line_start_ : text[length - 1] == '\n';
+        uint64_t now_ms = 0;
+        // One entry per boundary crossed by this write
+        while (next_index_offset_ < current_file_size_ + length) {
+            size_t pos = next_index_offset_ > current_file_size_ ? next_index_offset_ - current_file_size_ : 0;
+            if (pos == 0 ? !starts_line : text[pos - 1] != '\n') {
+                const void* newline = std::memchr(text + pos, '\n', length - pos);
+                pos = newline != nullptr ? static_cast<size_t>(static_cast<const char*>(newline) - text) + 1 : length;
+            }
+            bool indexed = false;
+            while (pos < length && !indexed) {
+                const void* newline = std::memchr(text + pos, '\n', length - pos);
+                size_t line_end = newline != nullptr ? static_cast<size_t>(static_cast<const char*>(newline) - text) : length;
+                uint32_t ms_of_day;
+                if (parse_entry_time(std::string_view(text + pos, line_end - pos), ms_of_day)) {
+                    if (now_ms == 0) {
+                        now_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count());
+                    }
+                    if (!index_.add(nearest_time_of_day(ms_of_day, now_ms), current_file_size_ + pos)) {
+                        index_.close();
+                        return;
+                    }
+                    next_index_offset_ = current_file_size_ + pos + index_block_bytes_;
+                    indexed = true;
+                }
+                pos = line_end + 1;
+            }
+            if (!indexed) {
+                return;  // No timestamped line left in this write: try the next one
+            }
+        }
+    }
+
+    void open_index() {
+        index_.open(current_filename_ + ".idx", static_cast<uint32_t>(index_block_bytes_));
+        next_index_offset_ = current_file_size_;
+        line_start_ = true;
+    }
+
     /**
      * @brief Get current date string in YYYY-MM-DD format
      */
@@ -191,6 +265,7 @@ private:
             daily_counter_ = 1;
             current_file_size_ = 0;
             open_file();
+            LOGZ_PROBE1(rotate, daily_counter_);
         }
     }
 
@@ -215,6 +290,9 @@ private:
             if (fstat(fd_, &st) == 0) {
                 current_file_size_ = st.st_size;
             }
+            if (index_block_bytes_ != 0) {
+                open_index();
+            }
         }
     }
 
@@ -222,6 +300,7 @@ private:
      * @brief Close the current log file
      */
     void close_file() {
+        index_.close();
         if (fd_ >= 0) {
             ::close(fd_);
             fd_ = -1;
@@ -236,6 +315,7 @@ private:
         daily_counter_++;
         current_file_size_ = 0;
         open_file();
+        LOGZ_PROBE1(rotate, daily_counter_);
     }
 
     std::string log_dir_;              // Log directory path
@@ -245,6 +325,10 @@ private:
     size_t current_file_size_;         // Current file size
     size_t daily_counter_;             // Daily counter (starts from 1)
     int fd_;                           // File descriptor for POSIX write
+    LogIndexWriter index_;             // Sidecar time index of the current file
+    size_t index_block_bytes_{0};      // Index spacing (0: no index)
+    size_t next_index_offset_{0};      // File offset from which the next line is indexed
+    bool line_start_{true};            // Last byte written ended a line
 };
 
 } // namespace logZ
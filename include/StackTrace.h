@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unwind.h>
+
+// Maximum number of frames captured by logZ::stacktrace()
+#ifndef LOGZ_STACKTRACE_DEPTH
+#define LOGZ_STACKTRACE_DEPTH 32
+#endif
+
+namespace logZ {
+
+/**
+ * @brief Raw return addresses captured on the logging thread
+ * 
+ * Pass as a LOG_xxx argument; only depth + addresses are encoded into the
+ * entry (2 + 8 * depth bytes). Symbolization happens on the backend thread.
+ */
+struct StackTrace {
+    uint16_t depth{0};
+    void* frames[LOGZ_STACKTRACE_DEPTH];
+};
+
+namespace detail {
+
+struct UnwindState {
+    StackTrace* trace;
+    int skip;
+};
+
+inline _Unwind_Reason_Code unwind_callback(struct _Unwind_Context* context, void* arg) {
+    auto* state = static_cast<UnwindState*>(arg);
+    uintptr_t ip = _Unwind_GetIP(context);
+    if (ip == 0) {
+        return _URC_END_OF_STACK;
+    }
+    if (state->skip > 0) {
+        --state->skip;
+        return _URC_NO_REASON;
+    }
+    state->trace->frames[state->trace->depth++] = reinterpret_cast<void*>(ip);
+    return state->trace->depth < LOGZ_STACKTRACE_DEPTH ? _URC_NO_REASON : _URC_END_OF_STACK;
+}
+
+} // namespace detail
+
+/**
+ * @brief Capture the calling thread's stack (return addresses only)
+ * 
+ * Usage: LOG_ERROR("order rejected {}{}", code, logZ::stacktrace());
+ * 
+ * Uses _Unwind_Backtrace (works without frame pointers), capped at
+ * LOGZ_STACKTRACE_DEPTH frames. Frame 0 is the caller of stacktrace().
+ * Link the executable with -rdynamic to get its own function names;
+ * otherwise frames show as module+offset (resolvable with addr2line).
+ */
+__attribute__((noinline))
+inline StackTrace stacktrace() {
+    StackTrace trace;
+    detail::UnwindState state{&trace, 1};  // Skip stacktrace() itself
+    _Unwind_Backtrace(&detail::unwind_callback, &state);
+    return trace;
+}
+
+/**
+ * @brief Address-to-symbol cache used by the backend
+ * 
+ * dladdr() + __cxa_demangle() cost several microseconds per frame, so each
+ * address is resolved once. Backend thread only in practice; the mutex
+ * keeps it safe for other users.
+ */
+class Symbolizer {
+public:
+    static Symbolizer& instance() {
+        static Symbolizer symbolizer;
+        return symbolizer;
+    }
+
+    /**
+     * @brief Render frames as "\n    #i 0xaddr symbol+0xoff (module)" lines
+     */
+    std::string format(const void* const* frames, size_t depth) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string result;
+        char prefix[48];
+        for (size_t i = 0; i < depth; ++i) {
+            std::snprintf(prefix, sizeof(prefix), "\n    #%zu %p ", i, frames[i]);
+            result += prefix;
+            // Every frame (0 included) is a return address, just past the call: look up the call instruction
+            result += resolve(static_cast<const char*>(frames[i]) - 1);
+        }
+        return result;
+    }
+
+private:
+    Symbolizer() = default;
+
+    const std::string& resolve(const void* address) {
+        auto it = cache_.find(address);
+        if (it != cache_.end()) {
+            return it->second;
+        }
+
+        std::string symbol;
+        Dl_info info;
+        if (::dladdr(address, &info) != 0) {
+            const char* module = info.dli_fname ? info.dli_fname : "?";
+            char offset[32];
+            if (info.dli_sname != nullptr) {
+                int status = 0;
+                char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                symbol = (status == 0 && demangled != nullptr) ? demangled : info.dli_sname;
+                std::free(demangled);
+                std::snprintf(offset, sizeof(offset), "+0x%zx",
+                              static_cast<size_t>(static_cast<const char*>(address) -
+                                                  static_cast<const char*>(info.dli_saddr)));
+            } else {
+                symbol = "??";
+                std::snprintf(offset, sizeof(offset), "+0x%zx",
+                              static_cast<size_t>(static_cast<const char*>(address) -
+                                                  static_cast<const char*>(info.dli_fbase)));
+            }
+            symbol += offset;
+            symbol += " (";
+            symbol += module;
+            symbol += ")";
+        } else {
+            symbol = "??";
+        }
+        return cache_.emplace(address, std::move(symbol)).first->second;
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<const void*, std::string> cache_;
+};
+
+} // namespace logZ
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace logZ {
+
+/**
+ * @brief Values published in the stats page (index into StatsPageLayout::values)
+ * New fields are appended; readers use field_count to skip unknown ones.
+ */
+enum class StatsField : uint32_t {
+    UPDATE_TIME_NS = 0,      // Wall clock of the last publish
+    ENTRIES_PROCESSED,       // Entries consumed by the backend
+    DROPPED_MESSAGES,        // Backend::get_dropped_count()
+    QUOTA_REJECTED,          // Entries over per-thread byte quotas
+    QUEUE_COUNT,             // Registered producer queues
+    QUEUE_MEMORY_BYTES,      // Capacity of all producer rings
+    QUEUED_BYTES,            // Encoded bytes waiting in producer queues
+    BACKEND_LAG_NS,          // Age of the oldest entry still queued
+    FLUSH_COUNT,             // flush_to_disk() calls
+    LAST_FLUSH_NS,           // Duration of the last flush_to_disk() (write + fdatasync)
+    MAX_FLUSH_NS,            // Longest flush_to_disk() so far
+    COUNT
+};
+
+/**
+ * @brief Name, Prometheus type and help text of each StatsField
+ */
+struct StatsFieldInfo {
+    const char* name;
+    const char* type;
+    const char* help;
+};
+
+inline constexpr StatsFieldInfo STATS_FIELDS[] = {
+    {"logz_update_time_seconds", "gauge", "Time of the last stats page update"},
+    {"logz_entries_processed_total", "counter", "Log entries consumed by the backend"},
+    {"logz_dropped_messages_total", "counter", "Log entries dropped because a queue was full"},
+    {"logz_quota_rejected_total", "counter", "Log entries dropped by per-thread byte quotas"},
+    {"logz_queues", "gauge", "Registered producer queues"},
+    {"logz_queue_memory_bytes", "gauge", "Capacity of all producer ring buffers"},
+    {"logz_queued_bytes", "gauge", "Encoded bytes waiting in producer queues"},
+    {"logz_backend_lag_seconds", "gauge", "Age of the oldest entry still queued"},
+    {"logz_flushes_total", "counter", "Flushes of the output buffer to the log file"},
+    {"logz_last_flush_seconds", "gauge", "Duration of the last flush (write + fdatasync)"},
+    {"logz_max_flush_seconds", "gauge", "Longest flush so far"},
+};
+static_assert(sizeof(STATS_FIELDS) / sizeof(STATS_FIELDS[0]) == static_cast<size_t>(StatsField::COUNT));
+
+/**
+ * @brief Memory layout of the stats page (the file format)
+ *
+ * Seqlock: the writer makes seq odd, stores the values, then makes it even
+ * again. A reader retries while seq is odd or changed during its copy, up to
+ * StatsPage::READ_ATTEMPTS times (a writer that died mid-update leaves seq odd).
+ */
+struct StatsPageLayout {
+    static constexpr uint64_t MAGIC = 0x31545453475A474CULL;  // "LGZGSTT1"
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t field_count;                    // Values present (StatsField::COUNT of the writer)
+    uint64_t pid;
+    alignas(64) std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> values[64];        // Room for fields added later
+};
+
+static_assert(static_cast<size_t>(StatsField::COUNT) <= 64);
+
+/**
+ * @brief Writer side: a small file (normally under /dev/shm) mapped MAP_SHARED
+ *
+ * Only the backend thread publishes; external tools map the file read-only
+ * (tools/logz_stats) and never make the process do any work.
+ */
+class StatsPage {
+public:
+    StatsPage() = default;
+    ~StatsPage() { close(); }
+
+    StatsPage(const StatsPage&) = delete;
+    StatsPage& operator=(const StatsPage&) = delete;
+
+    /**
+     * @brief Create and map the page
+     * @return false if the file cannot be created or mapped
+     */
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        void* block = MAP_FAILED;
+        if (::ftruncate(fd, sizeof(StatsPageLayout)) == 0) {
+            block = ::mmap(nullptr, sizeof(StatsPageLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (block == MAP_FAILED) {
+            ::unlink(path.c_str());
+            return false;
+        }
+        page_ = static_cast<StatsPageLayout*>(block);
+        page_->version = StatsPageLayout::VERSION;
+        page_->field_count = static_cast<uint32_t>(StatsField::COUNT);
+        page_->pid = static_cast<uint64_t>(::getpid());
+        page_->seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        page_->magic = StatsPageLayout::MAGIC;  // Last: readers check it first
+        path_ = path;
+        return true;
+    }
+
+    /**
+     * @brief Unmap and remove the page
+     */
+    void close() {
+        if (page_ != nullptr) {
+            ::munmap(page_, sizeof(StatsPageLayout));
+            ::unlink(path_.c_str());
+            page_ = nullptr;
+            path_.clear();
+        }
+    }
+
+    bool is_open() const {
+        return page_ != nullptr;
+    }
+
+    const std::string& path() const {
+        return path_;
+    }
+
+    /**
+     * @brief Publish a full set of values (single writer)
+     * @param values StatsField::COUNT values, indexed by StatsField
+     */
+    void publish(const uint64_t* values) {
+        uint64_t seq = page_->seq.load(std::memory_order_relaxed);
+        page_->seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < static_cast<size_t>(StatsField::COUNT); ++i) {
+            page_->values[i].store(values[i], std::memory_order_relaxed);
+        }
+        page_->seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Copies tried by read() before it gives up on a torn page
+    static constexpr uint32_t READ_ATTEMPTS = 1000;
+
+    /**
+     * @brief Consistent copy of a mapped page (reader side)
+     * @param values Receives field_count values (at most 64)
+     * @param torn Set to true if no consistent copy was obtained in READ_ATTEMPTS
+     *             tries: the writer is stuck mid-update (e.g. died while publishing)
+     * @return Number of values copied, 0 if the page is not a logZ stats page or torn
+     */
+    static size_t read(const StatsPageLayout* page, uint64_t* values, bool* torn = nullptr) {
+        if (torn != nullptr) {
+            *torn = false;
+        }
+        if (page->magic != StatsPageLayout::MAGIC || page->version != StatsPageLayout::VERSION) {
+            return 0;
+        }
+        size_t count = page->field_count < 64 ? page->field_count : 64;
+        for (uint32_t attempt = 0; attempt < READ_ATTEMPTS; ++attempt) {
+            uint64_t before = page->seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                ::sched_yield();  // Writer active
+                continue;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = page->values[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (page->seq.load(std::memory_order_relaxed) == before) {
+                return count;
+            }
+        }
+        if (torn != nullptr) {
+            *torn = true;
+        }
+        return 0;
+    }
+
+private:
+    StatsPageLayout* page_{nullptr};
+    std::string path_;
+};
+
+} // namespace logZ
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <string>
@@ -201,6 +202,13 @@ public:
         return to_read;
     }
 
+    /**
+     * @brief Get the number of bytes currently buffered
+     */
+    size_t size() const {
+        return get_used_space();
+    }
+
     /**
      * @brief Check if buffer is empty
      */
@@ -208,6 +216,24 @@ public:
         return read_ == write_;
     }
 
+    /**
+     * @brief Append all buffered bytes to another buffer and clear this one
+     */
+    void move_to(StringRingBuffer& target) {
+        size_t used = get_used_space();
+        if (target.get_free_space() < used) {
+            target.expand(used);
+        }
+        if (write_ >= read_) {
+            target.write_block(data_ + read_, used);
+        } else {
+            target.write_block(data_ + read_, capacity_ - read_);
+            target.write_block(data_, write_);
+        }
+        read_ = 0;
+        write_ = 0;
+    }
+
     /**
      * @brief Flush all data to sinker and clear buffer
      */
@@ -244,6 +270,16 @@ private:
         }
     }
 
+    /**
+     * @brief Write bytes to the buffer with at most two memcpy calls (space already checked)
+     */
+    void write_block(const std::byte* src, size_t length) {
+        size_t first_part = std::min(length, capacity_ - write_);
+        std::memcpy(data_ + write_, src, first_part);
+        std::memcpy(data_, src + first_part, length - first_part);
+        write_ = (write_ + length) & capacity_mask_;
+    }
+
     /**
      * @brief Read bytes from the buffer
      */
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "LogTypes.h"
+#include "Decoder.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace logZ {
+
+/**
+ * @brief One log entry as seen by a subscriber (no text rendering)
+ * 
+ * All views point into the producer queue entry and are valid only during
+ * the callback; copy what must outlive it.
+ */
+struct LogRecordView {
+    LogLevel level;              // Log level
+    uint64_t tsc;                // Raw TSC timestamp (see timestamp_ns())
+    DecoderFunc decoder;         // Identifies the call site (format + argument types)
+    std::string_view format;     // Format string of the call site
+    std::string_view context;    // ScopedContext prefix of the producing thread (may be empty)
+    const std::byte* args_data;  // Encoded arguments (nullptr if none)
+    uint32_t args_size;          // Encoded argument bytes
+    ArgExtractor extract;        // Typed access to args_data
+
+    /**
+     * @brief Read the arguments as typed values
+     * @param out Destination array
+     * @param max Capacity of out
+     * @return Number of values written
+     */
+    size_t args(ArgValue* out, size_t max) const {
+        if (extract == nullptr || args_data == nullptr) {
+            return 0;
+        }
+        return extract(args_data, out, max);
+    }
+
+    /**
+     * @brief Wall-clock timestamp in nanoseconds since the epoch
+     */
+    uint64_t timestamp_ns() const {
+        return tsc_to_ns(tsc);
+    }
+};
+
+/**
+ * @brief Subscriber callback (runs on the backend thread)
+ */
+using LogSubscriber = std::function<void(const LogRecordView&)>;
+
+/**
+ * @brief In-process consumers of decoded entries
+ * 
+ * Callbacks run on the backend thread, in entry order, before the text line
+ * is formatted. They should be short: a slow subscriber delays all output.
+ * The mutex only serializes add/remove against dispatch; active() is
+ * updated under it, from the list size after each change.
+ */
+class SubscriberList {
+public:
+    /**
+     * @brief Register a callback
+     * @return Id for remove()
+     */
+    size_t add(LogSubscriber subscriber) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t id = ++last_id_;
+        subscribers_.emplace_back(id, std::move(subscriber));
+        active_.store(true, std::memory_order_relaxed);
+        return id;
+    }
+
+    /**
+     * @brief Unregister a callback
+     * @return true if the id was registered
+     * Must not be called from inside a callback.
+     */
+    bool remove(size_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = subscribers_.begin(); it != subscribers_.end(); ++it) {
+            if (it->first == id) {
+                subscribers_.erase(it);
+                active_.store(!subscribers_.empty(), std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Check if a subscriber is registered (one relaxed load, no lock)
+     */
+    bool active() const {
+        return active_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Deliver one entry to all subscribers (backend thread)
+     */
+    void dispatch(const Metadata& metadata, const std::byte* args, std::string_view context) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (subscribers_.empty()) {
+            return;
+        }
+
+        // Call-site info cached per decoder: no DecoderRegistry lock per entry
+        auto it = call_sites_.find(metadata.decoder);
+        if (it == call_sites_.end()) {
+            it = call_sites_.emplace(metadata.decoder, DecoderRegistry::instance().find(metadata.decoder)).first;
+        }
+
+        LogRecordView record{metadata.level, metadata.timestamp, metadata.decoder, it->second.format,
+                             context, args, metadata.args_size, it->second.extract};
+        for (auto& [id, subscriber] : subscribers_) {
+            subscriber(record);
+        }
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::pair<size_t, LogSubscriber>> subscribers_;
+    std::unordered_map<DecoderFunc, DecoderInfo> call_sites_;
+    size_t last_id_{0};
+    std::atomic<bool> active_{false};   // !subscribers_.empty(), written under mutex_
+};
+
+} // namespace logZ
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "LogTypes.h"
+#include "StringRingBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <unistd.h>
+
+namespace logZ {
+
+/**
+ * @brief Writes TRACE_BEGIN / TRACE_END entries as a Chrome JSON trace
+ * 
+ * Output is the "JSON Object Format" ({"traceEvents":[...]}) understood by
+ * chrome://tracing and ui.perfetto.dev:
+ * - one track per producer thread (tid = OS thread id, named once with a
+ *   thread_name metadata event)
+ * - ts in microseconds with nanosecond decimals, converted from the entry's
+ *   TSC with TscCalibration
+ * 
+ * The event name is the entry's format string rendered by its decoder, into
+ * a scratch buffer owned by the sink. Only the backend thread writes events;
+ * the mutex serializes open()/close() from other threads.
+ */
+class TraceSink {
+public:
+    TraceSink() : scratch_(1024) {}
+
+    ~TraceSink() {
+        close();
+    }
+
+    // Disable copy and move
+    TraceSink(const TraceSink&) = delete;
+    TraceSink& operator=(const TraceSink&) = delete;
+    TraceSink(TraceSink&&) = delete;
+    TraceSink& operator=(TraceSink&&) = delete;
+
+    /**
+     * @brief Start a new trace file (closes the current one)
+     * @return true if the file could be created
+     */
+    bool open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        close_locked();
+        file_.open(path, std::ios::out | std::ios::trunc);
+        if (!file_.is_open()) {
+            return false;
+        }
+        file_ << "{\"traceEvents\":[";
+        first_event_ = true;
+        named_threads_.clear();
+        return true;
+    }
+
+    /**
+     * @brief Terminate the JSON document and close the file
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        close_locked();
+    }
+
+    /**
+     * @brief Write one trace entry (backend thread)
+     * @param metadata Entry metadata (kind TRACE_BEGIN or TRACE_END)
+     * @param args Encoded arguments of the name
+     * @param tid OS thread id of the producer (0 if unknown)
+     * @param thread_name Track name, written the first time tid is seen
+     */
+    void write_event(const Metadata& metadata, const std::byte* args, uint32_t tid, std::string_view thread_name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!file_.is_open()) {
+            return;
+        }
+
+        if (named_threads_.insert(tid).second) {
+            begin_event();
+            file_ << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid_ << ",\"tid\":" << tid
+                  << ",\"args\":{\"name\":\"";
+            write_escaped(thread_name.empty() ? std::string_view("thread") : thread_name);
+            file_ << "\"}}";
+        }
+
+        // Render the name with the entry's decoder
+        std::string name;
+        if (metadata.decoder != nullptr) {
+            {
+                auto writer = scratch_.get_writer();
+                using ActualDecoderFunc = void (*)(const std::byte*, StringRingBuffer::StringWriter&);
+                reinterpret_cast<ActualDecoderFunc>(metadata.decoder)(args, writer);
+            }
+            name.resize(scratch_.size());
+            scratch_.read(reinterpret_cast<std::byte*>(name.data()), name.size());
+        }
+
+        uint64_t ns = tsc_to_ns(metadata.timestamp);
+        char ts[32];
+        std::snprintf(ts, sizeof(ts), "%llu.%03llu",
+                      static_cast<unsigned long long>(ns / 1000),
+                      static_cast<unsigned long long>(ns % 1000));
+
+        begin_event();
+        file_ << "{\"name\":\"";
+        write_escaped(name);
+        file_ << "\",\"ph\":\"" << (metadata.kind == EntryKind::TRACE_BEGIN ? 'B' : 'E')
+              << "\",\"ts\":" << ts << ",\"pid\":" << pid_ << ",\"tid\":" << tid << "}";
+    }
+
+    /**
+     * @brief Flush buffered events to the file
+     */
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_.is_open()) {
+            file_.flush();
+        }
+    }
+
+private:
+    void close_locked() {
+        if (file_.is_open()) {
+            file_ << "\n]}\n";
+            file_.close();
+        }
+    }
+
+    void begin_event() {
+        file_ << (first_event_ ? "\n" : ",\n");
+        first_event_ = false;
+    }
+
+    void write_escaped(std::string_view text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                file_ << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                file_ << escaped;
+            } else {
+                file_ << c;
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::ofstream file_;
+    StringRingBuffer scratch_;                   // Decoder output for event names
+    std::unordered_set<uint32_t> named_threads_; // Tracks with a thread_name event
+    bool first_event_{true};
+    const int pid_{static_cast<int>(::getpid())};
+};
+
+} // namespace logZ
@@ -0,0 +1,10 @@
+// Second translation unit of test_logger: a LOG_xxx call site whose holder
+// is instantiated here, run from a static initializer in test_logger.cpp.
+// Dynamic initialization across translation units is unordered, so the call
+// site's switch must be valid before this file's initializers have run.
+#include "Logger.h"
+
+bool log_from_other_translation_unit() {
+    LOG_INFO("Logged during static initialization {}", 7);
+    return LOGZ_CALL_SITE(::logZ::LogLevel::INFO, "Logged during static initialization {}").is_enabled();
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "Logger.h"
 #include "Backend.h"
+#define LOGZ_ALLOC_COUNTER_INTERPOSE  // This binary counts allocations per thread
+#include "AllocCounter.h"
+#include "LogIndex.h"
 #include <thread>
 #include <vector>
 #include <chrono>
@@ -8,6 +11,13 @@
 #include <filesystem>
 #include <string>
 #include <cstring>
+#include <poll.h>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace logZ;
 
@@ -49,6 +59,10 @@ std::string read_log_from_dir(const std::string& log_dir) {
     return "";
 }
 
+// Defined in static_init_site.cpp, called before main()
+bool log_from_other_translation_unit();
+static const bool g_static_init_site_enabled = log_from_other_translation_unit();
+
 // Test fixture
 class LoggerTest : public ::testing::Test {
 protected:
@@ -402,6 +416,1710 @@ TEST_F(LoggerTest, DifferentLogLevels) {
     EXPECT_TRUE(content.find("Error message") != std::string::npos);
 }
 
+// ============================================================
+// Manual Poll Mode Tests
+// ============================================================
+
+TEST_F(LoggerTest, PollModeProcessesWithinBudget) {
+    auto& backend = Logger::get_backend();
+
+    for (int i = 0; i < 10; ++i) {
+        LOG_INFO("Polled message {}", i);
+    }
+
+    EXPECT_EQ(backend.poll(4), 4u);
+    size_t processed = 4;
+    while (size_t n = backend.poll(4)) {
+        processed += n;
+    }
+    EXPECT_EQ(processed, 10u);
+    backend.flush_to_disk();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("Polled message 9") != std::string::npos);
+}
+
+TEST_F(LoggerTest, PollModeEventFdSignalsOnNewEntry) {
+    auto& backend = Logger::get_backend();
+    int fd = backend.enable_notifications();
+    ASSERT_GE(fd, 0);
+
+    while (backend.poll() > 0) {}
+    ASSERT_TRUE(backend.prepare_wait());
+
+    std::thread producer([]() {
+        LOG_INFO("Wake up backend {}", 1);
+        LOG_INFO("Wake up backend {}", 2);
+    });
+    producer.join();
+
+    pollfd pfd{fd, POLLIN, 0};
+    ASSERT_EQ(::poll(&pfd, 1, 1000), 1);
+    EXPECT_EQ(backend.poll(), 2u);
+    backend.flush_to_disk();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("Wake up backend 2") != std::string::npos);
+}
+
+TEST_F(LoggerTest, PollModeStopDrainsRemainingEntries) {
+    auto& backend = Logger::get_backend();
+
+    for (int i = 0; i < 10; ++i) {
+        LOG_INFO("Left for stop {}", i);
+    }
+    EXPECT_EQ(backend.poll(4), 4u);  // Output stays buffered: below FLUSH_INTERVAL_NS
+
+    // The loop exits: stop() processes the rest and flushes without a consumer thread
+    backend.stop();
+    EXPECT_TRUE(backend.output_empty());
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("Left for stop 3") != std::string::npos);
+    EXPECT_TRUE(content.find("Left for stop 9") != std::string::npos);
+}
+
+// ============================================================
+// Per-CPU Queue Tests
+// ============================================================
+
+TEST(PerCpuQueuesTest, CurrentCpuMatchesScheduler) {
+    // Both reads race with migration, so only check the range
+    EXPECT_LT(PerCpuQueues::current_cpu(), PerCpuQueues::configured_cpus());
+}
+
+TEST(PerCpuQueuesTest, BusySlotFallsBackToAnotherSlot) {
+    Queue q0(4096), q1(4096);
+    PerCpuQueues per_cpu(2);
+    per_cpu.bind(0, &q0);
+    per_cpu.bind(1, &q1);
+
+    auto* first = per_cpu.acquire();
+    ASSERT_NE(first, nullptr);
+    auto* second = per_cpu.acquire();
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first->queue, second->queue);
+
+    // Both slots owned: reservation fails instead of blocking
+    EXPECT_EQ(per_cpu.acquire(), nullptr);
+
+    per_cpu.release(first);
+    per_cpu.release(second);
+    EXPECT_NE(per_cpu.acquire(), nullptr);
+}
+
+TEST_F(LoggerTest, PerCpuBusySlotsFallBackToThreadQueue) {
+    if (!LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "Needs LOGZ_PER_CPU_QUEUES";
+    }
+    auto& backend = Logger::get_backend();
+    backend.reset_dropped_count();
+
+    // Every slot owned, as if their writers had been preempted mid-write
+    PerCpuQueues& per_cpu = backend.per_cpu_queues();
+    std::vector<PerCpuQueues::Slot*> held;
+    while (auto* slot = per_cpu.acquire()) {
+        held.push_back(slot);
+    }
+    ASSERT_EQ(held.size(), per_cpu.size());
+
+    LOG_INFO("Written while all slots are busy {}", 42);
+    for (auto* slot : held) {
+        per_cpu.release(slot);
+    }
+
+    backend.start();
+    backend.stop();
+    EXPECT_EQ(backend.get_dropped_count(), 0u);
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("Written while all slots are busy 42") != std::string::npos);
+}
+
+// ============================================================
+// Shared MPSC Ring Tests
+// ============================================================
+
+TEST(MpscRingTest, ConsumerStopsAtUnpublishedRecord) {
+    MpscRing ring(256);
+
+    std::byte* first = ring.reserve_write(16);
+    std::byte* second = ring.reserve_write(16);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    std::memset(second, 0x22, 16);
+    ring.commit_write(second);
+
+    // First record reserved but not published: nothing readable yet
+    EXPECT_EQ(ring.read(16), nullptr);
+
+    std::memset(first, 0x11, 16);
+    ring.commit_write(first);
+    std::byte* data = ring.read(16);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(data[0], std::byte{0x11});
+    ring.commit_read(16);
+
+    data = ring.read(16);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(data[0], std::byte{0x22});
+    ring.commit_read(16);
+    EXPECT_TRUE(ring.is_empty());
+}
+
+TEST(MpscRingTest, WrapsWithPaddingAndRejectsWhenFull) {
+    MpscRing ring(256);
+
+    // Fill and drain repeatedly so records hit the buffer end
+    for (int i = 0; i < 100; ++i) {
+        std::byte* p = ring.reserve_write(40);
+        ASSERT_NE(p, nullptr);
+        p[0] = static_cast<std::byte>(i);
+        ring.commit_write(p);
+        std::byte* data = ring.read(40);
+        ASSERT_NE(data, nullptr);
+        EXPECT_EQ(data[0], static_cast<std::byte>(i));
+        ring.commit_read(40);
+    }
+
+    int reserved = 0;
+    while (std::byte* p = ring.reserve_write(40)) {
+        ring.commit_write(p);
+        ++reserved;
+    }
+    EXPECT_GT(reserved, 0);
+    EXPECT_LE(reserved * 48, 256);
+}
+
+TEST_F(LoggerTest, TransientThreadUsesSharedRing) {
+    auto& backend = Logger::get_backend();
+    backend.start();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([i]() {
+            Logger::mark_thread_transient();
+            LOG_INFO("Transient task {} done", i);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    for (int i = 0; i < 8; ++i) {
+        std::string search_str = "Transient task " + std::to_string(i) + " done";
+        EXPECT_TRUE(content.find(search_str) != std::string::npos);
+    }
+}
+
+TEST_F(LoggerTest, ShortLivedThreadsSwitchToSharedRing) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "No per-thread queues with LOGZ_PER_CPU_QUEUES";
+    }
+    auto& backend = Logger::get_backend();
+    backend.set_auto_transient_threshold(3);
+    backend.start();
+
+    for (int i = 0; i < 4; ++i) {
+        std::thread([i]() { LOG_INFO("Short-lived thread {}", i); }).join();
+    }
+    EXPECT_TRUE(backend.transient_by_default());
+
+    std::thread([]() { LOG_INFO("Thread on shared ring {}", 1); }).join();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+    backend.set_auto_transient_threshold(0);
+    EXPECT_FALSE(backend.transient_by_default());
+
+    // Disabling reset the count: one more short-lived thread does not switch again
+    backend.set_auto_transient_threshold(3);
+    std::thread([]() { LOG_INFO("Short-lived thread {}", 4); }).join();
+    EXPECT_FALSE(backend.transient_by_default());
+    backend.set_auto_transient_threshold(0);
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("Short-lived thread 3") != std::string::npos);
+    EXPECT_TRUE(content.find("Thread on shared ring 1") != std::string::npos);
+}
+
+// ============================================================
+// Call-Site Statistics Tests
+// ============================================================
+
+TEST_F(LoggerTest, CallSiteStatsRankByFormattedBytes) {
+    auto& backend = Logger::get_backend();
+    backend.reset_call_site_stats();
+    backend.enable_call_site_stats(true);
+    backend.start();
+
+    std::string payload(200, 'x');
+    for (int i = 0; i < 10; ++i) {
+        LOG_INFO("Noisy call site {}", payload);
+    }
+    for (int i = 0; i < 30; ++i) {
+        LOG_INFO("Quiet call site {}", i);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+    backend.enable_call_site_stats(false);
+
+    auto rows = backend.get_top_call_sites(2);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0].format, "Noisy call site {}");
+    EXPECT_EQ(rows[0].count, 10u);
+    EXPECT_GT(rows[0].formatted_bytes, 10u * 200u);
+    EXPECT_GT(rows[0].encoded_bytes, 10u * 200u);
+    EXPECT_EQ(rows[1].format, "Quiet call site {}");
+    EXPECT_EQ(rows[1].count, 30u);
+}
+
+TEST_F(LoggerTest, CallSiteStatsPeriodicDump) {
+    auto& backend = Logger::get_backend();
+    backend.set_call_site_report_interval(std::chrono::milliseconds(1), 3);
+
+    LOG_INFO("Reported call site {}", 7);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    while (backend.poll() > 0) {}
+    backend.set_call_site_report_interval(std::chrono::milliseconds(0));
+    backend.enable_call_site_stats(false);
+    backend.flush_to_disk();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("[STATS]") != std::string::npos);
+    EXPECT_TRUE(content.find("format=\"Reported call site {}\"") != std::string::npos);
+}
+
+// ============================================================
+// Runtime Call-Site Switch Tests
+// ============================================================
+
+TEST_F(LoggerTest, DisabledCallSiteSkipsQueue) {
+    auto& backend = Logger::get_backend();
+    backend.start();
+
+    // Both expansions below share the format, so the pattern matches two sites
+    EXPECT_EQ(backend.set_call_sites_enabled("*Switchable site*", false), 2u);
+    LOG_INFO("Switchable site {}", 1);
+    EXPECT_EQ(backend.set_call_sites_enabled("*Switchable site*", true), 2u);
+    LOG_INFO("Switchable site {}", 2);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_FALSE(content.find("Switchable site 1") != std::string::npos);
+    EXPECT_TRUE(content.find("Switchable site 2") != std::string::npos);
+}
+
+TEST_F(LoggerTest, CallSitesRegisteredAtStaticInit) {
+    bool found = false;
+    for (const auto& site : CallSiteRegistry::instance().list()) {
+        // Registered although this line has not run yet
+        if (site.format == "Never executed call site {}") {
+            found = true;
+            EXPECT_EQ(site.location.rfind("test_logger.cpp:", 0), 0u);
+            EXPECT_EQ(site.level, LogLevel::WARN);
+            EXPECT_TRUE(site.enabled);
+        }
+    }
+    EXPECT_TRUE(found);
+    if (!found) {
+        LOG_WARN("Never executed call site {}", 0);
+    }
+}
+
+TEST_F(LoggerTest, CallSiteEnabledDuringStaticInit) {
+    // The LOG_INFO ran from a static initializer of this file, in another translation unit
+    EXPECT_TRUE(g_static_init_site_enabled);
+
+    auto& backend = Logger::get_backend();
+    backend.start();
+    backend.stop();
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("Logged during static initialization 7") != std::string::npos);
+}
+
+TEST_F(LoggerTest, ControlFileTogglesCallSites) {
+    auto& backend = Logger::get_backend();
+    std::filesystem::create_directories(log_dir_);
+    std::string control = log_dir_ + "/logz.ctl";
+
+    const int muted_line = __LINE__ + 2;
+    auto log_both = [](int i) {
+        LOG_INFO("Muted site {}", i);
+        LOG_INFO("Other site {}", i);
+    };
+    std::ofstream(control) << "# silence one line\ndisable test_logger.cpp:" << muted_line << "\n";
+    backend.watch_control_file(control);
+
+    log_both(1);
+    while (backend.poll() > 0) {}  // Applies the control file before processing
+    log_both(2);
+    while (backend.poll() > 0) {}
+    backend.watch_control_file("");
+    backend.set_call_sites_enabled("*Muted site*", true);
+    backend.flush_to_disk();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("Muted site 1") != std::string::npos);
+    EXPECT_FALSE(content.find("Muted site 2") != std::string::npos);
+    EXPECT_TRUE(content.find("Other site 2") != std::string::npos);
+}
+
+// ============================================================
+// Per-Thread Level Tests
+// ============================================================
+
+TEST_F(LoggerTest, ThreadLevelOverrideIsPerThread) {
+    auto& backend = Logger::get_backend();
+    backend.set_default_thread_level(LogLevel::INFO);
+    backend.start();
+
+    std::thread quiet([]() {
+        LOG_DEBUG("Debug from default thread {}", 1);
+        LOG_INFO("Info from default thread {}", 1);
+    });
+    std::thread verbose([]() {
+        Logger::set_thread_level(LogLevel::DEBUG);
+        LOG_DEBUG("Debug from verbose thread {}", 2);
+    });
+    quiet.join();
+    verbose.join();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+    backend.set_default_thread_level(Logger::MinLevel);
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_FALSE(content.find("Debug from default thread 1") != std::string::npos);
+    EXPECT_TRUE(content.find("Info from default thread 1") != std::string::npos);
+    EXPECT_TRUE(content.find("Debug from verbose thread 2") != std::string::npos);
+}
+
+TEST_F(LoggerTest, BackendSetsLevelOfAnotherThread) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "No per-thread registration with LOGZ_PER_CPU_QUEUES";
+    }
+    auto& backend = Logger::get_backend();
+    backend.start();
+
+    std::atomic<int> step{0};
+    std::thread worker([&step]() {
+        LOG_INFO("Worker registered {}", 0);
+        step = 1;
+        while (step != 2) { std::this_thread::yield(); }
+        LOG_INFO("Worker info after raise {}", 1);
+        LOG_ERROR("Worker error after raise {}", 1);
+    });
+    while (step != 1) { std::this_thread::yield(); }
+    EXPECT_TRUE(backend.set_thread_level(worker.get_id(), LogLevel::ERROR));
+    step = 2;
+    worker.join();
+    EXPECT_FALSE(backend.set_thread_level(worker.get_id(), LogLevel::ERROR));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_FALSE(content.find("Worker info after raise 1") != std::string::npos);
+    EXPECT_TRUE(content.find("Worker error after raise 1") != std::string::npos);
+}
+
+TEST_F(LoggerTest, DefaultLevelKeepsExplicitThreadLevels) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "No per-thread registration with LOGZ_PER_CPU_QUEUES";
+    }
+    auto& backend = Logger::get_backend();
+    backend.start();
+
+    std::atomic<int> registered{0};
+    std::atomic<bool> go{false};
+    std::thread own([&]() {
+        Logger::set_thread_level(LogLevel::ERROR);
+        LOG_ERROR("Own level registered {}", 0);
+        ++registered;
+        while (!go) { std::this_thread::yield(); }
+        LOG_INFO("Own level info after default {}", 1);
+    });
+    std::thread remote([&]() {
+        LOG_INFO("Remote level registered {}", 0);
+        ++registered;
+        while (!go) { std::this_thread::yield(); }
+        LOG_INFO("Remote level info after default {}", 1);
+    });
+    while (registered != 2) { std::this_thread::yield(); }
+    EXPECT_TRUE(backend.set_thread_level(remote.get_id(), LogLevel::WARN));
+    backend.set_default_thread_level(LogLevel::DEBUG);  // Both levels were set explicitly
+    go = true;
+    own.join();
+    remote.join();
+    backend.set_default_thread_level(Logger::MinLevel);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("Own level registered 0") != std::string::npos);
+    EXPECT_FALSE(content.find("Own level info after default 1") != std::string::npos);
+    EXPECT_FALSE(content.find("Remote level info after default 1") != std::string::npos);
+}
+
+TEST_F(LoggerTest, ByteQuotaRejectsRunawayThread) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "No per-thread registration with LOGZ_PER_CPU_QUEUES";
+    }
+    auto& backend = Logger::get_backend();
+    backend.start();
+
+    std::atomic<int> step{0};
+    std::thread noisy([&step]() {
+        LOG_INFO("Noisy registered {}", 0);
+        step = 1;
+        while (step != 2) { std::this_thread::yield(); }
+        for (int i = 0; i < 200; ++i) {
+            LOG_INFO("Noisy entry {}", i);
+        }
+    });
+    while (step != 1) { std::this_thread::yield(); }
+    std::thread::id noisy_id = noisy.get_id();
+    EXPECT_TRUE(backend.set_thread_quota(noisy_id, 1000, 1000));
+    step = 2;
+    noisy.join();
+    LOG_INFO("Quiet thread unaffected {}", 1);
+
+    auto rejections = backend.get_quota_rejections();
+    ASSERT_EQ(rejections.size(), 1u);
+    EXPECT_EQ(rejections[0].thread, noisy_id);
+    EXPECT_GT(rejections[0].rejected, 100u);
+    EXPECT_LT(rejections[0].rejected, 200u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_NE(content.find("Noisy entry 0"), std::string::npos);
+    EXPECT_EQ(content.find("Noisy entry 199"), std::string::npos);
+    EXPECT_NE(content.find("Quiet thread unaffected 1"), std::string::npos);
+    EXPECT_NE(content.find("byte quota exceeded on thread"), std::string::npos);
+}
+
+TEST_F(LoggerTest, RemovingLastByteQuotaDisablesReports) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "No per-thread registration with LOGZ_PER_CPU_QUEUES";
+    }
+    auto& backend = Logger::get_backend();
+    LOG_INFO("Quota owner registered {}", 0);
+    std::thread::id self = std::this_thread::get_id();
+
+    EXPECT_TRUE(backend.set_thread_quota(self, 1000000));
+    EXPECT_TRUE(backend.quotas_enabled());
+    backend.set_default_thread_quota(1000000);
+    EXPECT_TRUE(backend.set_thread_quota(self, 0));
+    EXPECT_TRUE(backend.quotas_enabled());  // The default still applies to new threads
+    backend.set_default_thread_quota(0);
+    EXPECT_FALSE(backend.quotas_enabled());
+}
+
+TEST_F(LoggerTest, DropMarkerWrittenWhereGapHappened) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "No per-thread registration with LOGZ_PER_CPU_QUEUES";
+    }
+    auto& backend = Logger::get_backend();
+    backend.start();
+
+    std::atomic<int> step{0};
+    std::thread worker([&step]() {
+        LOG_INFO("Before gap {}", 0);
+        step = 1;
+        while (step != 2) { std::this_thread::yield(); }
+        for (int i = 0; i < 10; ++i) {
+            LOG_INFO("Inside gap {}", i);
+        }
+        step = 3;
+        while (step != 4) { std::this_thread::yield(); }
+        LOG_INFO("After gap {}", 0);
+    });
+    while (step != 1) { std::this_thread::yield(); }
+    std::thread::id worker_id = worker.get_id();
+    backend.set_thread_quota(worker_id, 1, 1);  // Every entry over quota
+    step = 2;
+    while (step != 3) { std::this_thread::yield(); }
+    backend.set_thread_quota(worker_id, 0);
+    step = 4;
+    worker.join();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    size_t before = content.find("Before gap 0");
+    size_t marker = content.find("10 messages dropped on thread ");
+    size_t after = content.find("After gap 0");
+    ASSERT_NE(marker, std::string::npos);
+    EXPECT_LT(before, marker);
+    EXPECT_LT(marker, after);
+    EXPECT_EQ(content.find("Inside gap"), std::string::npos);
+}
+
+// ============================================================
+// Scoped Context Tests
+// ============================================================
+
+TEST_F(LoggerTest, ScopedContextPrefixesLines) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "No per-thread context with LOGZ_PER_CPU_QUEUES";
+    }
+    auto& backend = Logger::get_backend();
+    backend.start();
+
+    std::thread worker([]() {
+        LOG_INFO("Before context {}", 0);
+        {
+            ScopedContext request("request_id", 42);
+            LOG_INFO("Inside request {}", 1);
+            {
+                ScopedContext order("order", std::string("ABC"));
+                LOG_INFO("Inside order {}", 2);
+            }
+            LOG_INFO("Order closed {}", 3);
+        }
+        LOG_INFO("After context {}", 4);
+    });
+    std::thread other([]() {
+        LOG_INFO("Other thread line {}", 5);
+    });
+    worker.join();
+    other.join();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    auto line_of = [&content](const std::string& text) {
+        size_t pos = content.find(text);
+        if (pos == std::string::npos) {
+            return std::string();
+        }
+        size_t begin = content.rfind('\n', pos);
+        begin = (begin == std::string::npos) ? 0 : begin + 1;
+        return content.substr(begin, content.find('\n', pos) - begin);
+    };
+    EXPECT_EQ(line_of("Before context 0").find('='), std::string::npos);
+    EXPECT_NE(line_of("Inside request 1").find("[request_id=42] Inside request 1"), std::string::npos);
+    EXPECT_NE(line_of("Inside order 2").find("[request_id=42 order=ABC] Inside order 2"), std::string::npos);
+    EXPECT_NE(line_of("Order closed 3").find("[request_id=42] Order closed 3"), std::string::npos);
+    EXPECT_EQ(line_of("After context 4").find('='), std::string::npos);
+    EXPECT_EQ(line_of("Other thread line 5").find('='), std::string::npos);
+}
+
+TEST_F(LoggerTest, ScopedContextSentOnlyBeforeEntries) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "No per-thread context with LOGZ_PER_CPU_QUEUES";
+    }
+    auto& backend = Logger::get_backend();
+
+    LOG_INFO("Context traffic baseline {}", 0);  // Registers this thread's queue
+    Queue& queue = Logger::get_thread_queue();
+    size_t queued = queue.available_read();
+    for (int i = 0; i < 100; ++i) {
+        ScopedContext scope("iteration", i);  // Nothing logged inside: no record
+    }
+    EXPECT_EQ(queue.available_read(), queued);
+
+    {
+        ScopedContext scope("iteration", 100);
+        LOG_INFO("Context traffic logged {}", 1);
+    }
+    LOG_INFO("Context traffic after scope {}", 2);
+
+    backend.start();
+    backend.stop();
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_NE(content.find("[iteration=100] Context traffic logged 1"), std::string::npos);
+    size_t after = content.find("Context traffic after scope 2");
+    ASSERT_NE(after, std::string::npos);
+    std::string last_line = content.substr(content.rfind('\n', after) + 1, after - content.rfind('\n', after));
+    EXPECT_EQ(last_line.find("iteration"), std::string::npos) << last_line;  // Scope closed: prefix cleared
+}
+
+// ============================================================
+// Streaming Copy Tests
+// ============================================================
+
+TEST(EncoderTest, StreamCopyMatchesMemcpy) {
+    std::string source(1000, '\0');
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<char>('a' + i % 26);
+    }
+    alignas(64) std::byte target[1100];
+    for (size_t offset : {0, 1, 2, 15, 16, 17}) {
+        for (size_t len : {0, 1, 15, 16, 17, 100, 1000}) {
+            std::memset(target, 0, sizeof(target));
+            detail::stream_copy(target + offset, source.data(), len);
+            EXPECT_EQ(std::memcmp(target + offset, source.data(), len), 0) << offset << " " << len;
+            EXPECT_EQ(target[offset + len], std::byte{0}) << offset << " " << len;
+        }
+    }
+}
+
+TEST_F(LoggerTest, LongStringsRoundTripThroughStreamingCopy) {
+    // test_logger_nt_store lowers LOGZ_NT_STORE_THRESHOLD so these take the NT branch
+    auto& backend = Logger::get_backend();
+    backend.start();
+    std::vector<std::string> payloads;
+    for (size_t len : {63, 64, 65, 257, 1000, 4001}) {
+        std::string payload(len, '\0');
+        for (size_t i = 0; i < len; ++i) {
+            payload[i] = static_cast<char>('A' + (i * 7 + len) % 26);
+        }
+        LOG_INFO("Streamed {} [{}]", len, payload);
+        payloads.push_back(std::move(payload));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    for (const auto& payload : payloads) {
+        EXPECT_NE(content.find("Streamed " + std::to_string(payload.size()) + " [" + payload + "]"),
+                  std::string::npos) << payload.size();
+    }
+}
+
+// ============================================================
+// Log-to-Metrics Tests
+// ============================================================
+
+TEST(DecoderRegistryTest, ExtractsTypedArguments) {
+    LOG_INFO("Extract typed {} {} {} {}", -7, 42u, 2.5, std::string("abc"));
+    auto decoder = reinterpret_cast<DecoderFunc>(
+        get_decoder<FixedString("Extract typed {} {} {} {}"), int, unsigned, double, std::string>());
+    DecoderInfo info = DecoderRegistry::instance().find(decoder);
+    ASSERT_NE(info.extract, nullptr);
+
+    int i = -7; unsigned u = 42; double d = 2.5; std::string str = "abc";
+    std::vector<std::byte> buffer(calculate_args_size(i, u, d, str));
+    encode_args(buffer.data(), i, u, d, str);
+
+    ArgValue values[8];
+    ASSERT_EQ(info.extract(buffer.data(), values, 8), 4u);
+    EXPECT_EQ(values[0].type, ArgValue::Type::INT);
+    EXPECT_EQ(values[0].i, -7);
+    EXPECT_EQ(values[1].type, ArgValue::Type::UINT);
+    EXPECT_EQ(values[1].u, 42u);
+    EXPECT_EQ(values[2].type, ArgValue::Type::DOUBLE);
+    EXPECT_DOUBLE_EQ(values[2].d, 2.5);
+    EXPECT_EQ(values[3].type, ArgValue::Type::STRING);
+    EXPECT_EQ(values[3].str, "abc");
+}
+
+TEST_F(LoggerTest, MetricsAggregateArgumentsAndDropText) {
+    auto& backend = Logger::get_backend();
+    backend.add_metric_counter("fills", "Fill received*");
+    backend.add_metric_histogram("fill_latency_us", "Fill received*", 1, {10.0, 100.0}, true);
+    backend.start();
+
+    LOG_INFO("Fill received order={} latency_us={}", 1, 5);
+    LOG_INFO("Fill received order={} latency_us={}", 2, 50);
+    LOG_INFO("Fill received order={} latency_us={}", 3, 500);
+    LOG_INFO("Unrelated line {}", 4);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    auto metrics = backend.get_metrics();
+    backend.reset_metrics();
+    const MetricSnapshot* counter = nullptr;
+    const MetricSnapshot* histogram = nullptr;
+    for (const auto& metric : metrics) {
+        if (metric.name == "fills") counter = &metric;
+        if (metric.name == "fill_latency_us") histogram = &metric;
+    }
+    ASSERT_NE(counter, nullptr);
+    ASSERT_NE(histogram, nullptr);
+    EXPECT_EQ(counter->count, 3u);
+    EXPECT_TRUE(counter->buckets.empty());
+    EXPECT_EQ(histogram->count, 3u);
+    EXPECT_DOUBLE_EQ(histogram->sum, 555.0);
+    EXPECT_DOUBLE_EQ(histogram->min, 5.0);
+    EXPECT_DOUBLE_EQ(histogram->max, 500.0);
+    EXPECT_EQ(histogram->buckets, (std::vector<uint64_t>{1, 1, 1}));
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_FALSE(content.find("Fill received") != std::string::npos);
+    EXPECT_TRUE(content.find("Unrelated line 4") != std::string::npos);
+}
+
+TEST_F(LoggerTest, MetricAddedWhileRunningRebindsCallSites) {
+    auto& backend = Logger::get_backend();
+    backend.add_metric_counter("quotes_before", "Quote update*");
+    backend.start();
+
+    LOG_INFO("Quote update {}", 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));  // Call site bound to the first metric
+    backend.add_metric_histogram("quote_px", "Quote update*", 0, {10.0});
+    LOG_INFO("Quote update {}", 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    backend.stop();
+
+    auto metrics = backend.get_metrics();
+    backend.reset_metrics();
+    for (const auto& metric : metrics) {
+        if (metric.name == "quotes_before") {
+            EXPECT_EQ(metric.count, 2u);
+        } else if (metric.name == "quote_px") {
+            EXPECT_EQ(metric.count, 1u);
+            EXPECT_DOUBLE_EQ(metric.sum, 2.0);
+        }
+    }
+}
+
+// ============================================================
+// Subscriber Tests
+// ============================================================
+
+TEST_F(LoggerTest, SubscriberReceivesTypedEntries) {
+    struct Received {
+        LogLevel level;
+        uint64_t tsc;
+        std::string format;
+        int64_t order;
+        std::string symbol;
+    };
+    std::mutex mutex;
+    std::vector<Received> received;
+
+    auto& backend = Logger::get_backend();
+    size_t id = backend.add_subscriber([&](const LogRecordView& record) {
+        if (record.format.find("Subscribed order") == std::string_view::npos) {
+            return;
+        }
+        ArgValue values[4];
+        size_t n = record.args(values, 4);
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(Received{record.level, record.tsc, std::string(record.format),
+                                    n > 0 ? values[0].i : -1,
+                                    n > 1 ? std::string(values[1].str) : std::string()});
+    });
+    backend.start();
+
+    uint64_t before = __rdtsc();
+    LOG_WARN("Subscribed order {} {}", 7, std::string("AAPL"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(backend.remove_subscriber(id));
+    EXPECT_FALSE(backend.remove_subscriber(id));
+    LOG_WARN("Subscribed order {} {}", 8, std::string("MSFT"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0].level, LogLevel::WARN);
+    EXPECT_GE(received[0].tsc, before);
+    EXPECT_EQ(received[0].format, "Subscribed order {} {}");
+    EXPECT_EQ(received[0].order, 7);
+    EXPECT_EQ(received[0].symbol, "AAPL");
+
+    // Text output is unaffected
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_TRUE(content.find("Subscribed order 7 AAPL") != std::string::npos);
+    EXPECT_TRUE(content.find("Subscribed order 8 MSFT") != std::string::npos);
+}
+
+// ============================================================
+// Scope Timer Tests
+// ============================================================
+
+TEST_F(LoggerTest, ScopeTimerLogsDuration) {
+    auto& backend = Logger::get_backend();
+    backend.add_scope_timer_histogram("timed_block_ns", "Timed block*", {1e6, 1e9});
+    backend.start();
+
+    {
+        LOG_SCOPE_TIMER("Timed block {}", std::string("load"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        LOG_INFO("Inside timed block {}", 1);
+    }
+    {
+        LOG_SCOPE_TIMER("Timed block without args");
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    size_t inside = content.find("Inside timed block 1");
+    size_t timed = content.find("Timed block load took ");
+    ASSERT_NE(inside, std::string::npos);
+    ASSERT_NE(timed, std::string::npos);
+    EXPECT_LT(inside, timed);  // Logged on scope exit
+    EXPECT_NE(content.find("ms", timed), std::string::npos);
+    EXPECT_NE(content.find("Timed block without args took "), std::string::npos);
+
+    for (const auto& metric : backend.get_metrics()) {
+        if (metric.name == "timed_block_ns") {
+            EXPECT_EQ(metric.count, 2u);
+            EXPECT_GE(metric.max, 5e6);
+            EXPECT_EQ(metric.buckets[0], 1u);  // The empty scope took < 1ms
+            EXPECT_EQ(metric.buckets[1], 1u);
+        }
+    }
+}
+
+TEST_F(LoggerTest, ScopeTimerDurationIsLastWithMaxArgs) {
+    auto& backend = Logger::get_backend();
+    backend.add_scope_timer_histogram("timed_many_args_ns", "Many args*", {1e9});
+    backend.start();
+
+    {
+        // 16 user arguments: the duration must still be the observed value
+        const int64_t big = 7000000000LL;
+        LOG_SCOPE_TIMER("Many args {} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {}",
+                        big, big, big, big, big, big, big, big, big, big, big, big, big, big, big, big);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    bool found = false;
+    for (const auto& metric : backend.get_metrics()) {
+        if (metric.name == "timed_many_args_ns") {
+            found = true;
+            EXPECT_EQ(metric.count, 1u);
+            EXPECT_LT(metric.max, 1e9);
+            EXPECT_EQ(metric.buckets[0], 1u);
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
+// ============================================================
+// Trace Output Tests
+// ============================================================
+
+TEST_F(LoggerTest, TraceMacrosWriteChromeJson) {
+    const std::string trace_path = "./test_trace.json";
+    auto& backend = Logger::get_backend();
+
+    TRACE_BEGIN("Not traced {}", 0);  // No trace file yet: dropped at the call site
+    ASSERT_TRUE(backend.open_trace_file(trace_path));
+    backend.start();
+
+    std::thread worker([]() {
+        pthread_setname_np(pthread_self(), "trace-worker");
+        TRACE_SCOPE("Outer span {}", 1);
+        TRACE_BEGIN("Inner \"span\" {}", 2);
+        LOG_INFO("Log inside span {}", 3);
+        TRACE_END();
+    });
+    worker.join();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+    backend.close_trace_file();
+
+    std::ifstream file(trace_path);
+    std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::filesystem::remove(trace_path);
+
+    EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(trace.find("]}"), std::string::npos);
+    EXPECT_EQ(trace.find("Not traced"), std::string::npos);
+    if (!LOGZ_PER_CPU_QUEUES) {  // Per-CPU queues have no thread track
+        EXPECT_NE(trace.find("\"args\":{\"name\":\"trace-worker\"}"), std::string::npos);
+    }
+    size_t outer = trace.find("\"name\":\"Outer span 1\",\"ph\":\"B\"");
+    size_t inner = trace.find("\"name\":\"Inner \\\"span\\\" 2\",\"ph\":\"B\"");
+    ASSERT_NE(outer, std::string::npos);
+    ASSERT_NE(inner, std::string::npos);
+    EXPECT_LT(outer, inner);
+
+    size_t end_count = 0;
+    for (size_t pos = trace.find("\"ph\":\"E\""); pos != std::string::npos;
+         pos = trace.find("\"ph\":\"E\"", pos + 1)) {
+        ++end_count;
+    }
+    EXPECT_EQ(end_count, 2u);
+
+    // Trace entries produce no text lines; logs are unaffected
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_EQ(content.find("Outer span"), std::string::npos);
+    EXPECT_NE(content.find("Log inside span 3"), std::string::npos);
+}
+
+TEST_F(LoggerTest, TraceEndOnlyForWrittenBegin) {
+    const std::string trace_path = "./test_trace_pairs.json";
+    auto& backend = Logger::get_backend();
+
+    std::thread worker([&backend, &trace_path]() {
+        TRACE_BEGIN("Begun before tracing {}", 0);  // Not written: its END must not be either
+        ASSERT_TRUE(backend.open_trace_file(trace_path));
+        backend.start();
+
+        TRACE_BEGIN("Outer pair {}", 1);
+        for (int i = 0; i < 2; ++i) {
+            if (i == 1) {
+                backend.set_call_sites_enabled("Disabled pair*", false);
+            }
+            TRACE_BEGIN("Disabled pair {}", i);  // Written on the first pass only
+            LOG_INFO("Inside pair {}", i);
+            TRACE_END();
+        }
+        TRACE_END();
+        TRACE_END();  // Matches "Begun before tracing"
+    });
+    worker.join();
+    backend.set_call_sites_enabled("Disabled pair*", true);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+    backend.close_trace_file();
+
+    std::ifstream file(trace_path);
+    std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::filesystem::remove(trace_path);
+
+    auto count = [&trace](const std::string& needle) {
+        size_t n = 0;
+        for (size_t pos = trace.find(needle); pos != std::string::npos; pos = trace.find(needle, pos + 1)) {
+            ++n;
+        }
+        return n;
+    };
+    EXPECT_EQ(count("\"ph\":\"B\""), 2u);  // "Outer pair 1", "Disabled pair 0"
+    EXPECT_EQ(count("\"ph\":\"E\""), 2u);
+    EXPECT_EQ(trace.find("Disabled pair 1"), std::string::npos);
+    EXPECT_EQ(trace.find("Begun before tracing"), std::string::npos);
+}
+
+TEST_F(LoggerTest, TraceEndSkippedForDroppedBegin) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "No shared ring with LOGZ_PER_CPU_QUEUES";
+    }
+    const std::string trace_path = "./test_trace_dropped.json";
+    auto& backend = Logger::get_backend();
+    ASSERT_TRUE(backend.open_trace_file(trace_path));
+
+    std::thread worker([&backend]() {
+        Logger::mark_thread_transient();
+        // Fill the shared ring while the backend is stopped
+        std::string filler(1000, 'f');
+        uint64_t dropped = backend.get_dropped_count();
+        while (backend.get_dropped_count() == dropped) {
+            LOG_INFO("Filler {}", filler);
+        }
+        TRACE_BEGIN("Dropped span {}", filler);  // As large as the dropped entry: neither BEGIN nor END
+        backend.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Drain the ring
+        TRACE_BEGIN("Kept span {}", 2);
+        TRACE_END();
+        TRACE_END();  // Matches "Dropped span"
+    });
+    worker.join();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+    backend.close_trace_file();
+
+    std::ifstream file(trace_path);
+    std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::filesystem::remove(trace_path);
+
+    auto count = [&trace](const std::string& needle) {
+        size_t n = 0;
+        for (size_t pos = trace.find(needle); pos != std::string::npos; pos = trace.find(needle, pos + 1)) {
+            ++n;
+        }
+        return n;
+    };
+    EXPECT_EQ(count("\"ph\":\"B\""), 1u);  // "Kept span 2"
+    EXPECT_EQ(count("\"ph\":\"E\""), 1u);
+    EXPECT_EQ(trace.find("Dropped span"), std::string::npos);
+}
+
+// ============================================================
+// Stack Trace Tests
+// ============================================================
+
+__attribute__((noinline)) void log_error_with_stacktrace() {
+    LOG_ERROR("Failure with trace{}", logZ::stacktrace());
+    asm volatile("");  // Keep the call above from becoming a tail call
+}
+
+TEST_F(LoggerTest, StackTraceSymbolizedByBackend) {
+    StackTrace trace = logZ::stacktrace();
+    EXPECT_GT(trace.depth, 0u);
+    EXPECT_LE(trace.depth, LOGZ_STACKTRACE_DEPTH);
+    EXPECT_EQ(calculate_single_arg_size(trace), sizeof(uint16_t) + trace.depth * sizeof(void*));
+
+    auto& backend = Logger::get_backend();
+    backend.start();
+    log_error_with_stacktrace();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    size_t pos = content.find("Failure with trace\n    #0 0x");
+    ASSERT_NE(pos, std::string::npos);
+    EXPECT_NE(content.find("log_error_with_stacktrace()", pos), std::string::npos);
+}
+
+TEST_F(LoggerTest, StackTraceNotSymbolizedForSubscribers) {
+    auto& backend = Logger::get_backend();
+    std::atomic<int> seen{0};
+    ArgValue values[2];
+    size_t id = backend.add_subscriber([&](const LogRecordView& record) {
+        if (record.format == "Trace then value{} {}") {
+            EXPECT_EQ(record.args(values, 2), 2u);
+            seen.fetch_add(1);
+        }
+    });
+    backend.start();
+    LOG_WARN("Trace then value{} {}", logZ::stacktrace(), 42);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+    backend.remove_subscriber(id);
+
+    ASSERT_EQ(seen.load(), 1);
+    EXPECT_EQ(values[0].type, ArgValue::Type::NONE);  // Placeholder, no dladdr() on this path
+    EXPECT_EQ(values[1].type, ArgValue::Type::INT);
+    EXPECT_EQ(values[1].i, 42);
+}
+
+// ============================================================
+// Deferred Formatting Tests
+// ============================================================
+
+TEST_F(LoggerTest, ErrnoErrorCodeAndChronoFormattedByBackend) {
+    ErrnoValue err = logZ::errno_val(ENOENT);
+    EXPECT_EQ(calculate_single_arg_size(err), sizeof(int));
+    EXPECT_EQ(calculate_single_arg_size(std::chrono::milliseconds(5)), sizeof(int64_t));
+
+    auto& backend = Logger::get_backend();
+    backend.start();
+
+    errno = EACCES;
+    LOG_ERROR("Open failed: {}", logZ::errno_val());
+    LOG_ERROR("Explicit errno: {}", err);
+    LOG_ERROR("Error code: {}", std::make_error_code(std::errc::timed_out));
+    LOG_INFO("Elapsed {} and {}", std::chrono::milliseconds(250), std::chrono::microseconds(3));
+    LOG_INFO("Uptime {}", std::chrono::steady_clock::time_point(std::chrono::seconds(42)));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_NE(content.find("Open failed: " + std::string(std::strerror(EACCES)) + " (" +
+                           std::to_string(EACCES) + ")"), std::string::npos);
+    EXPECT_NE(content.find("Explicit errno: " + std::string(std::strerror(ENOENT))), std::string::npos);
+    EXPECT_NE(content.find("Error code: " + std::make_error_code(std::errc::timed_out).message() +
+                           " (generic:"), std::string::npos);
+    EXPECT_NE(content.find("Elapsed 250ms and 3"), std::string::npos);
+    EXPECT_NE(content.find("Uptime 42"), std::string::npos);
+}
+
+TEST_F(LoggerTest, ErrnoReachesSubscribersAsInteger) {
+    auto& backend = Logger::get_backend();
+    std::atomic<int> seen{0};
+    ArgValue values[2];
+    size_t id = backend.add_subscriber([&](const LogRecordView& record) {
+        if (record.format == "Errno for subscriber {} {}") {
+            record.args(values, 2);
+            seen.fetch_add(1);
+        }
+    });
+    backend.start();
+    LOG_ERROR("Errno for subscriber {} {}", logZ::errno_val(ENOENT), std::make_error_code(std::errc::timed_out));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+    backend.remove_subscriber(id);
+
+    ASSERT_EQ(seen.load(), 1);
+    EXPECT_EQ(values[0].type, ArgValue::Type::INT);
+    EXPECT_EQ(values[0].i, ENOENT);
+    EXPECT_TRUE(values[0].str.starts_with(std::strerror(ENOENT)));
+    EXPECT_EQ(values[1].type, ArgValue::Type::INT);
+    EXPECT_EQ(values[1].i, static_cast<int>(std::errc::timed_out));
+    EXPECT_TRUE(values[1].str.starts_with(std::make_error_code(std::errc::timed_out).message()));
+}
+
+// ============================================================
+// Enum Name Tests
+// ============================================================
+
+enum class OrderSide : uint8_t { Buy = 1, Sell = 2 };
+enum RejectReason : int { REJECT_NONE = 0, REJECT_PRICE = -3, REJECT_QTY = 100 };
+enum LegacyFlag { LEGACY_OFF = 0, LEGACY_ON = 1 };  // No fixed underlying type
+enum class Venue : int16_t { Primary = 2, Dark = 900 };
+
+template<>
+struct logZ::enum_range<Venue> {
+    static constexpr long long min = 0, max = 1000;
+};
+
+static_assert(logZ::enum_name(OrderSide::Sell) == "Sell");
+static_assert(logZ::enum_name(REJECT_PRICE) == "REJECT_PRICE");
+static_assert(logZ::enum_name(static_cast<OrderSide>(7)).empty());
+static_assert(logZ::enum_name(LEGACY_ON).empty());  // Printed as an integer
+static_assert(logZ::enum_name(Venue::Dark) == "Dark");
+static_assert(logZ::EnumNames<OrderSide>::SIZE == 128);  // Clamped to [0, 127]
+static_assert(logZ::EnumNames<Venue>::SIZE == 1001);
+
+TEST_F(LoggerTest, EnumsPrintedByName) {
+    EXPECT_EQ(calculate_single_arg_size(OrderSide::Buy), sizeof(uint8_t));
+
+    auto& backend = Logger::get_backend();
+    backend.start();
+    LOG_INFO("Side {} reason {} unnamed {} legacy {}", OrderSide::Buy, REJECT_QTY, static_cast<OrderSide>(7),
+             LEGACY_ON);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_NE(content.find("Side Buy reason REJECT_QTY unnamed 7 legacy 1"), std::string::npos);
+}
+
+// ============================================================
+// Flush Barrier Tests
+// ============================================================
+
+TEST_F(LoggerTest, FlushUntilWritesWithoutStopping) {
+    auto& backend = Logger::get_backend();
+    backend.start();
+
+    std::thread worker([]() {
+        for (int i = 0; i < 1000; ++i) {
+            LOG_INFO("Barrier worker {}", i);
+        }
+    });
+    worker.join();
+    LOG_INFO("Barrier main {}", 1);
+
+    ASSERT_TRUE(backend.flush_until(__rdtsc(), std::chrono::seconds(5)));
+    // Everything up to the cutoff is on disk while the backend still runs
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_NE(content.find("Barrier worker 999"), std::string::npos);
+    EXPECT_NE(content.find("Barrier main 1"), std::string::npos);
+
+    LOG_INFO("After barrier {}", 2);
+    EXPECT_TRUE(backend.flush_until());
+    EXPECT_NE(read_log_from_dir("./logs").find("After barrier 2"), std::string::npos);
+    backend.stop();
+
+    // Without a consumer thread the caller drains
+    LOG_INFO("Stopped barrier {}", 3);
+    EXPECT_TRUE(backend.flush_until());
+    EXPECT_NE(read_log_from_dir("./logs").find("Stopped barrier 3"), std::string::npos);
+}
+
+TEST_F(LoggerTest, StopWithDeadline) {
+    auto& backend = Logger::get_backend();
+    backend.start();
+    LOG_INFO("Deadline stop {}", 1);
+    EXPECT_TRUE(backend.stop(std::chrono::steady_clock::now() + std::chrono::seconds(5)));
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_NE(content.find("Deadline stop 1"), std::string::npos);
+}
+
+TEST_F(LoggerTest, StopWithDeadlineReportsThisCallWithoutConsumer) {
+    auto& backend = Logger::get_backend();
+    for (int i = 0; i < 2000; ++i) {
+        LOG_INFO("Unstarted deadline stop {}", i);
+    }
+    // Drained on the caller: the result is this call's, not a previous stop's
+    EXPECT_FALSE(backend.stop(std::chrono::steady_clock::now() - std::chrono::seconds(1)));
+    EXPECT_TRUE(backend.stop(std::chrono::steady_clock::now() + std::chrono::seconds(5)));
+
+    std::string content = read_log_from_dir("./logs");
+    EXPECT_NE(content.find("Unstarted deadline stop 1999"), std::string::npos);
+}
+
+TEST_F(LoggerTest, StopWithDeadlineDrainsPastFullOutputBuffer) {
+    auto& backend = Logger::get_backend();
+    // 1025-byte lines leave the (power-of-two) output buffer a byte or two short of full
+    std::string padding(987, 'p');
+    for (int i = 1000; i < 4000; ++i) {
+        LOG_INFO("Full buffer {} {}", i, padding);
+    }
+    backend.start();
+    EXPECT_TRUE(backend.stop(std::chrono::steady_clock::now() + std::chrono::seconds(5)));
+
+    std::string content = read_log_from_dir("./logs");
+    size_t last = content.find("Full buffer 3999 ");
+    ASSERT_NE(last, std::string::npos);
+    EXPECT_EQ(content.find('\n', last) - content.rfind('\n', last), 1025u);  // Line length as sized above
+}
+
+// ============================================================
+// Allocation Check Tests
+// ============================================================
+
+TEST_F(LoggerTest, HotPathDoesNotAllocateAfterWarmUp) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "Shared per-CPU queues may grow because of other tests";
+    }
+    ASSERT_TRUE(AllocCounter::installed());
+    auto& backend = Logger::get_backend();
+
+    AllocReport steady;
+    AllocReport growth;
+    std::thread worker([&]() {
+        std::string_view name = "order";
+        auto log_once = [&](int i) {
+            LOG_INFO("Hot path {} {} {}", i, 2.5 * i, name);
+        };
+        log_once(0);  // Warm-up: queue, registration, call site
+
+        // Well within the first 4KB node
+        AllocCounter::arm();
+        for (int i = 1; i <= 20; ++i) {
+            log_once(i);
+        }
+        steady = AllocCounter::disarm();
+
+        // Backend stopped: the queue has to grow
+        AllocCounter::arm();
+        for (int i = 0; i < 500; ++i) {
+            log_once(i);
+        }
+        growth = AllocCounter::disarm();
+    });
+    worker.join();
+
+    EXPECT_EQ(steady.allocations, 0u) << steady.to_string();
+    EXPECT_EQ(steady.queue_growth_allocations, 0u);
+    // Growth is reported apart, not as a hot-path allocation
+    EXPECT_EQ(growth.allocations, 0u) << growth.to_string();
+    EXPECT_GT(growth.queue_growth_allocations, 0u);
+    EXPECT_NE(growth.to_string().find("for queue growth"), std::string::npos) << growth.to_string();
+
+    backend.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+}
+
+// ============================================================
+// Parallel Formatting Tests
+// ============================================================
+
+TEST_F(LoggerTest, FormatWorkersKeepGlobalOrder) {
+    auto& backend = Logger::get_backend();
+    backend.start();  // Entries queued earlier (static initialization) are not counted below
+    backend.stop();
+    backend.reset_log_count();
+    backend.reset_dropped_count();
+    backend.set_format_workers(3);
+    backend.start();
+
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                LOG_INFO("Parallel format {} {} {}", t, i, std::string(i % 64, 'x'));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    backend.stop();
+    backend.set_format_workers(0);
+#if LOGZ_PER_CPU_QUEUES
+    // A CPU queue shared by all threads may fill up and drop (counted) entries
+    const int expected = kThreads * kPerThread - static_cast<int>(backend.get_dropped_count());
+#else
+    const int expected = kThreads * kPerThread;
+    EXPECT_EQ(backend.get_dropped_count(), 0u);
+#endif
+    EXPECT_EQ(backend.get_log_count(), static_cast<uint64_t>(expected));
+
+    std::istringstream content(read_log_from_dir("./logs"));
+    std::string line;
+    std::vector<int> next(kThreads, 0);
+    int lines = 0;
+    while (std::getline(content, line)) {
+        size_t pos = line.find("Parallel format ");
+        if (pos == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields(line.substr(pos + 16));
+        int t = -1, i = -1;
+        fields >> t >> i;
+        ASSERT_TRUE(t >= 0 && t < kThreads) << line;
+        // Per-thread order only: a writer preempted between its timestamp and
+        // its commit is merged late, so times may step back across threads
+#if LOGZ_PER_CPU_QUEUES
+        EXPECT_GE(i, next[t]) << line;  // Gaps where entries were dropped
+#else
+        EXPECT_EQ(i, next[t]) << line;
+#endif
+        next[t] = i + 1;
+        ++lines;
+    }
+    EXPECT_EQ(lines, expected);
+}
+
+// ============================================================
+// Time Index Tests
+// ============================================================
+
+TEST_F(LoggerTest, TimeIndexSeeksToTimeRange) {
+    auto& backend = Logger::get_backend();
+    backend.enable_time_index(1024);
+    backend.start();
+    for (int i = 0; i < 3000; ++i) {
+        LOG_INFO("Indexed line {} {}", i, std::string(40, 'y'));
+        if (i % 500 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));  // Spread over several ms
+        }
+    }
+    backend.stop();
+    backend.enable_time_index(0);
+
+    std::string log_path = backend.current_log_file();
+    LogIndex index;
+    ASSERT_TRUE(index.load(log_path + ".idx"));
+    const auto& entries = index.entries();
+    ASSERT_GT(entries.size(), 10u);
+
+    // Every entry points at a line carrying its time
+    std::string content = read_log_file(log_path);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        ASSERT_LT(entries[i].offset, content.size());
+        ASSERT_TRUE(entries[i].offset == 0 || content[entries[i].offset - 1] == '\n');
+        uint32_t ms_of_day;
+        ASSERT_TRUE(parse_line_time(std::string_view(content).substr(entries[i].offset), ms_of_day));
+        EXPECT_EQ(entries[i].time_ms % MS_PER_DAY, ms_of_day);
+        if (i > 0) {
+            EXPECT_LE(entries[i - 1].time_ms, entries[i].time_ms);
+            EXPECT_GE(entries[i].offset - entries[i - 1].offset, 1024u);
+        }
+    }
+
+    // Extract the range between two entries: only lines inside it, starting at the first one
+    uint64_t from = entries.back().time_ms;
+    FILE* out = std::tmpfile();
+    long lines = index.extract(log_path, from, from, out);
+    EXPECT_GT(lines, 0);
+    std::rewind(out);
+    char line[256];
+    while (std::fgets(line, sizeof(line), out) != nullptr) {
+        if (is_report_line(line)) {
+            continue;  // Reports (e.g. [PROFILE] on stop) follow the line before them
+        }
+        uint32_t ms_of_day;
+        ASSERT_TRUE(parse_line_time(line, ms_of_day));
+        EXPECT_EQ(ms_of_day, from % MS_PER_DAY) << line;
+    }
+    std::fclose(out);
+    std::filesystem::remove(log_path + ".idx");
+}
+
+TEST(TimeIndexTest, ReportLinesDoNotOrderTheIndex) {
+    auto dir = std::filesystem::temp_directory_path() / ("logz_index_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(dir);
+    uint64_t now_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    auto stamp = [](uint64_t ms) {
+        uint64_t of_day = ms % MS_PER_DAY;
+        char text[16];
+        std::snprintf(text, sizeof(text), "%02u:%02u:%02u:%03u", static_cast<unsigned>(of_day / 3600000),
+                      static_cast<unsigned>(of_day / 60000 % 60), static_cast<unsigned>(of_day / 1000 % 60),
+                      static_cast<unsigned>(of_day % 1000));
+        return std::string(text);
+    };
+    // Reports are stamped when written, later than the entries around them
+    uint64_t t0 = now_ms - 100;
+    std::string padding(80, 'z');
+    std::vector<std::string> lines = {
+        "[INFO] " + stamp(t0) + " first " + padding + "\n",
+        "[METRIC] " + stamp(t0 + 10000) + " latency count=1 " + padding + "\n",
+        "[INFO] " + stamp(t0 + 1) + " second " + padding + "\n",
+        "[WARN] " + stamp(t0 + 10000) + " byte quota exceeded on thread 1: 3 entries dropped " + padding + "\n",
+        "[INFO] " + stamp(t0 + 2) + " third " + padding + "\n",
+        "[INFO] " + stamp(t0 + 3) + " fourth " + padding + "\n",
+    };
+    std::string log_path;
+    {
+        Sinker sinker(dir.string());
+        sinker.enable_index(64);
+        for (const auto& line : lines) {
+            ASSERT_TRUE(sinker.write(reinterpret_cast<const std::byte*>(line.data()), line.size()));
+        }
+        log_path = sinker.current_filename();
+    }
+
+    LogIndex index;
+    ASSERT_TRUE(index.load(log_path + ".idx"));
+    ASSERT_EQ(index.entries().size(), 4u);  // Only the [INFO] lines
+    for (size_t i = 0; i < index.entries().size(); ++i) {
+        EXPECT_EQ(index.entries()[i].time_ms, t0 + i);
+    }
+
+    // The reports follow the entries before them instead of ending the range
+    FILE* out = std::tmpfile();
+    EXPECT_EQ(index.extract(log_path, t0 + 1, t0 + 2, out), 3);
+    std::rewind(out);
+    char line[256];
+    for (size_t i : {2, 3, 4}) {
+        ASSERT_NE(std::fgets(line, sizeof(line), out), nullptr);
+        EXPECT_EQ(std::string(line), lines[i]);
+    }
+    std::fclose(out);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(TimeIndexTest, IndexCoversOnlyWrittenBytes) {
+    auto dir = std::filesystem::temp_directory_path() / ("logz_short_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string log_path;
+    int channel[2];
+    ASSERT_EQ(::pipe(channel), 0);
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        // Writes past 4 KB come up short, then fail with EFBIG
+        ::signal(SIGXFSZ, SIG_IGN);
+        Sinker sinker(dir.string());
+        sinker.enable_index(1);  // Every line
+        rlimit limit{4096, 4096};
+        ::setrlimit(RLIMIT_FSIZE, &limit);
+        for (int i = 0; i < 100; ++i) {
+            std::string line = "[INFO] 12:00:00:000 Limited line " + std::to_string(i) + " " + std::string(60, 'l') + "\n";
+            sinker.write(reinterpret_cast<const std::byte*>(line.data()), line.size());
+        }
+        std::string path = sinker.current_filename();
+        ssize_t r = ::write(channel[1], path.data(), path.size());
+        ::_exit(r == static_cast<ssize_t>(path.size()) ? 0 : 1);
+    }
+    ::close(channel[1]);
+    char path[4096];
+    ssize_t length = ::read(channel[0], path, sizeof(path));
+    ::close(channel[0]);
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    ASSERT_GT(length, 0);
+    log_path.assign(path, static_cast<size_t>(length));
+
+    std::string content = read_log_file(log_path);
+    EXPECT_EQ(content.size(), 4096u);
+    LogIndex index;
+    ASSERT_TRUE(index.load(log_path + ".idx"));
+    ASSERT_FALSE(index.entries().empty());
+    for (const auto& entry : index.entries()) {
+        ASSERT_LT(entry.offset, content.size());
+        EXPECT_TRUE(entry.offset == 0 || content[entry.offset - 1] == '\n');
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(TimeIndexTest, WriterFailsWhenHeaderCannotBeWritten) {
+    LogIndexWriter writer;
+    EXPECT_FALSE(writer.open("/dev/full", 1024));
+    EXPECT_FALSE(writer.is_open());
+}
+
+// ============================================================
+// Backend Profiling Tests
+// ============================================================
+
+TEST_F(LoggerTest, BackendProfileAccountsStages) {
+    auto& backend = Logger::get_backend();
+    backend.reset_backend_profile();
+    backend.start();
+    for (int i = 0; i < 1000; ++i) {
+        LOG_INFO("Profiled entry {} {}", i, 1.5);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    backend.stop();
+
+    BackendProfile profile = backend.backend_profile();
+    if constexpr (!BackendProfiler::enabled) {
+        EXPECT_EQ(profile.messages, 0u);  // Compiled out
+        return;
+    }
+    EXPECT_GE(profile.messages, 1000u);
+    EXPECT_GE(profile.sampled_messages, 1000u / BackendProfiler::SAMPLE_EVERY);
+    EXPECT_GT(profile.cycles_per_message(ProfileStage::MERGE), 0.0);
+    EXPECT_GT(profile.cycles_per_message(ProfileStage::BUFFER), 0.0);
+    EXPECT_GT(profile.cycles_per_message(ProfileStage::DECODE), 0.0);
+    EXPECT_GT(profile.cycles_per_message(ProfileStage::TIMESTAMP), 0.0);
+    EXPECT_GT(profile.cycles[static_cast<size_t>(ProfileStage::FLUSH)], 0u);
+    EXPECT_GT(profile.cycles[static_cast<size_t>(ProfileStage::IDLE)], 0u);
+    EXPECT_NE(read_log_from_dir("./logs").find("[PROFILE] "), std::string::npos);
+}
+
+// ============================================================
+// Stats Page Tests
+// ============================================================
+
+TEST_F(LoggerTest, StatsPagePublishesBackendCounters) {
+    auto& backend = Logger::get_backend();
+    std::string path = "./logz_stats_page";
+    ASSERT_TRUE(backend.enable_stats_page(path));
+    EXPECT_FALSE(backend.enable_stats_page(path));  // Once per Backend
+    backend.start();
+    for (int i = 0; i < 10; ++i) {
+        LOG_INFO("Stats page entry {}", i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    backend.stop();
+
+    // Read it the way an external tool does
+    int fd = ::open(path.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    void* block = ::mmap(nullptr, sizeof(StatsPageLayout), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    ASSERT_NE(block, MAP_FAILED);
+    uint64_t values[64];
+    size_t count = StatsPage::read(static_cast<const StatsPageLayout*>(block), values);
+    EXPECT_EQ(count, static_cast<size_t>(StatsField::COUNT));
+    EXPECT_GE(values[static_cast<size_t>(StatsField::ENTRIES_PROCESSED)], 10u);
+    EXPECT_GE(values[static_cast<size_t>(StatsField::QUEUE_COUNT)], 1u);
+    EXPECT_GT(values[static_cast<size_t>(StatsField::QUEUE_MEMORY_BYTES)], 0u);
+    EXPECT_GT(values[static_cast<size_t>(StatsField::UPDATE_TIME_NS)], 0u);
+    ::munmap(block, sizeof(StatsPageLayout));
+
+    EXPECT_TRUE(backend.disable_stats_page());
+    EXPECT_TRUE(backend.stats_page_path().empty());
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(StatsPageTest, ReadGivesUpOnTornPage) {
+    StatsPageLayout page{};
+    page.magic = StatsPageLayout::MAGIC;
+    page.version = StatsPageLayout::VERSION;
+    page.field_count = static_cast<uint32_t>(StatsField::COUNT);
+    page.seq.store(3, std::memory_order_relaxed);  // Writer died mid-update
+
+    uint64_t values[64];
+    bool torn = false;
+    EXPECT_EQ(StatsPage::read(&page, values, &torn), 0u);
+    EXPECT_TRUE(torn);
+
+    page.seq.store(4, std::memory_order_relaxed);
+    EXPECT_EQ(StatsPage::read(&page, values, &torn), static_cast<size_t>(StatsField::COUNT));
+    EXPECT_FALSE(torn);
+}
+
+// ============================================================
+// Crash Recovery Tests
+// ============================================================
+
+template<auto FMT, typename... Args>
+void enqueue_entry(Queue& queue, const Args&... args) {
+    size_t args_size = calculate_args_size(args...);
+    std::byte* buffer = queue.reserve_write(sizeof(Metadata) + args_size);
+    ASSERT_NE(buffer, nullptr);
+    encode_log_entry<FMT, LogLevel::WARN>(buffer, __rdtsc(), args_size, args...);
+    queue.commit_write(sizeof(Metadata) + args_size);
+}
+
+TEST(RecoveryTest, UnconsumedEntriesReadBackFromRingFiles) {
+    std::string dir = "./recovery_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    CallSiteTable table;
+    ASSERT_TRUE(table.open(dir + "/callsites"));
+    {
+        Queue queue(256, dir + "/queue-0");
+        std::string name = "abc";
+        for (int i = 0; i < 12; ++i) {
+            enqueue_entry<FixedString("Recovered {} pi={} name={}")>(queue, i, 2.5, name);
+        }
+        EXPECT_GT(queue.node_count(), 1u);  // Spans several ring files
+
+        // Consumed entries are not recovered
+        std::byte* meta = queue.read(sizeof(Metadata));
+        ASSERT_NE(meta, nullptr);
+        queue.commit_read(sizeof(Metadata) + reinterpret_cast<Metadata*>(meta)->args_size);
+
+        // Read while the "crashed" mapping is still alive: same page cache as after a crash
+        auto entries = RecoveryReader::recover(dir);
+        ASSERT_EQ(entries.size(), 11u);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            EXPECT_EQ(entries[i].text.rfind("[WARN] ", 0), 0u);
+            std::string expected = "Recovered " + std::to_string(i + 1) + " pi=2.5 name=abc";
+            EXPECT_EQ(entries[i].text.substr(entries[i].text.size() - expected.size()), expected);
+            EXPECT_EQ(entries[i].queue, "queue-0");
+        }
+    }
+    // Drained / destroyed rings remove their files
+    for (const auto& file : std::filesystem::directory_iterator(dir)) {
+        EXPECT_NE(file.path().extension(), ".ring");
+    }
+    table.close();
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerTest, PersistentQueuesRecoveredAfterKill) {
+    if (LOGZ_PER_CPU_QUEUES) {
+        GTEST_SKIP() << "Per-CPU queues are not file-backed";
+    }
+    const std::string run_dir = "./persistent_test";
+    std::filesystem::remove_all(run_dir);
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        // Backend never started: everything stays unconsumed in the ring files
+        if (!Logger::get_backend().enable_persistent_queues(run_dir)) {
+            ::_exit(2);
+        }
+        std::thread worker([]() {
+            for (int i = 0; i < 20; ++i) {
+                LOG_ERROR("Before crash {} of {}", i, std::string("order-book"));
+            }
+            LOG_ERROR("Short timing {}", 7);
+        });
+        worker.join();
+        ::_exit(0);  // No destructors, no drain: as after a kill
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+
+    // Stray files and corrupt lines are skipped with a warning, not fatal
+    std::string dir = run_dir + "/" + std::to_string(child);
+    std::ofstream(dir + "/notes.bak.ring") << "x";
+    std::ofstream(dir + "/callsites", std::ios::app) << "zz-not-hex\tu4\tBroken {}\n";
+
+    // A call site claiming a timing its entries are too short for renders without it
+    std::string callsites = read_log_file(dir + "/callsites");
+    size_t site = callsites.find("\tShort timing {}");
+    ASSERT_NE(site, std::string::npos);
+    size_t types = callsites.rfind('\t', site - 1) + 1;
+    callsites.replace(types, site - types, "t i4");
+    std::ofstream(dir + "/callsites", std::ios::trunc) << callsites;
+
+    std::string error;
+    std::vector<std::string> warnings;
+    auto entries = RecoveryReader::recover(dir, &error, &warnings);
+    EXPECT_TRUE(error.empty()) << error;
+    EXPECT_EQ(warnings.size(), 2u);
+    ASSERT_EQ(entries.size(), 21u);
+    EXPECT_NE(entries.back().text.find("Short timing 0"), std::string::npos) << entries.back().text;
+    EXPECT_EQ(entries.back().text.find(" took "), std::string::npos) << entries.back().text;
+    for (size_t i = 0; i + 1 < entries.size(); ++i) {
+        EXPECT_EQ(entries[i].text.rfind("[ERROR] ", 0), 0u);
+        std::string expected = "Before crash " + std::to_string(i) + " of order-book";
+        EXPECT_NE(entries[i].text.find(expected), std::string::npos) << entries[i].text;
+    }
+    std::filesystem::remove_all(run_dir);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
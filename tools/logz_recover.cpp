@@ -0,0 +1,38 @@
+// logz_recover: print the log entries a crashed process left in its ring files
+//
+// Usage: logz_recover <run_dir>/<pid> [--queue]
+//   Entries are printed oldest first, in the backend's line format.
+//   --queue prefixes each line with the queue it came from.
+
+#include "Recovery.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <run_dir>/<pid> [--queue]\n", argv[0]);
+        return 2;
+    }
+    bool show_queue = argc > 2 && std::strcmp(argv[2], "--queue") == 0;
+
+    std::string error;
+    std::vector<std::string> warnings;
+    auto entries = logZ::RecoveryReader::recover(argv[1], &error, &warnings);
+    if (!error.empty()) {
+        std::fprintf(stderr, "logz_recover: %s\n", error.c_str());
+        return 1;
+    }
+    for (const auto& warning : warnings) {
+        std::fprintf(stderr, "logz_recover: warning: %s\n", warning.c_str());
+    }
+    for (const auto& entry : entries) {
+        if (show_queue) {
+            std::printf("%s: ", entry.queue.c_str());
+        }
+        std::printf("%s\n", entry.text.c_str());
+    }
+    std::fprintf(stderr, "logz_recover: %zu unconsumed entries\n", entries.size());
+    return 0;
+}
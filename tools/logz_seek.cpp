@@ -0,0 +1,70 @@
+// logz_seek: print the lines of a time range of a log file using its .idx sidecar
+//
+// Usage: logz_seek <file.log> <from> [to]
+//   Times are written as in the log lines: HH:MM:SS[:mmm] (UTC time of day),
+//   or @<unix ms>. Without <to>, prints to the end of the file.
+//   The index comes from Backend::enable_time_index(); without one the file
+//   is scanned from the start.
+
+#include "LogIndex.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace logZ;
+
+namespace {
+
+/**
+ * @brief Parse "HH:MM:SS[:mmm]" or "@<unix ms>"
+ * @param end Without milliseconds, take the end of the second
+ */
+bool parse_time(const LogIndex& index, const char* text, bool end, uint64_t& time_ms) {
+    if (text[0] == '@') {
+        char* rest = nullptr;
+        time_ms = std::strtoull(text + 1, &rest, 10);
+        return rest != text + 1 && *rest == '\0';
+    }
+    std::string line = std::string("- ") + text;  // Same layout as a log line
+    if (std::strlen(text) == 8) {
+        line += end ? ":999" : ":000";
+    }
+    uint32_t ms_of_day;
+    if (!parse_line_time(line, ms_of_day)) {
+        return false;
+    }
+    time_ms = index.resolve_time_of_day(ms_of_day);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <file.log> <HH:MM:SS[:mmm] | @unix_ms> [to]\n", argv[0]);
+        return 2;
+    }
+    std::string log_path = argv[1];
+
+    LogIndex index;
+    std::string error;
+    if (!index.load(log_path + ".idx", &error)) {
+        std::fprintf(stderr, "logz_seek: %s, scanning from the start\n", error.c_str());
+    }
+
+    uint64_t from_ms = 0;
+    uint64_t to_ms = UINT64_MAX;
+    if (!parse_time(index, argv[2], false, from_ms) || (argc > 3 && !parse_time(index, argv[3], true, to_ms))) {
+        std::fprintf(stderr, "logz_seek: times are HH:MM:SS[:mmm] or @<unix ms>\n");
+        return 2;
+    }
+
+    long lines = index.extract(log_path, from_ms, to_ms, stdout);
+    if (lines < 0) {
+        std::fprintf(stderr, "logz_seek: cannot read %s\n", log_path.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+// logz_stats: print a process's logZ stats page in Prometheus text format
+//
+// Usage: logz_stats <pid | page path>
+//   A pid reads /dev/shm/logz.<pid> (Backend::enable_stats_page() default).
+//   Nanosecond fields are exported in seconds, as Prometheus expects.
+
+#include "StatsPage.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace logZ;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <pid | page path>\n", argv[0]);
+        return 2;
+    }
+    std::string path = argv[1];
+    if (path.find_first_not_of("0123456789") == std::string::npos) {
+        path = "/dev/shm/logz." + path;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::fprintf(stderr, "logz_stats: cannot open %s: %s\n", path.c_str(), std::strerror(errno));
+        return 1;
+    }
+    // A shorter file would fault (SIGBUS) on access past its end
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(StatsPageLayout))) {
+        std::fprintf(stderr, "logz_stats: %s is not a logZ stats page (too small)\n", path.c_str());
+        ::close(fd);
+        return 1;
+    }
+    void* block = ::mmap(nullptr, sizeof(StatsPageLayout), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (block == MAP_FAILED) {
+        std::fprintf(stderr, "logz_stats: cannot map %s\n", path.c_str());
+        return 1;
+    }
+    const auto* page = static_cast<const StatsPageLayout*>(block);
+    if (page->magic != StatsPageLayout::MAGIC) {
+        std::fprintf(stderr, "logz_stats: %s is not a logZ stats page (bad magic)\n", path.c_str());
+        ::munmap(block, sizeof(StatsPageLayout));
+        return 1;
+    }
+
+    uint64_t values[64];
+    bool torn = false;
+    size_t count = StatsPage::read(page, values, &torn);
+    if (count == 0) {
+        if (torn) {
+            std::fprintf(stderr, "logz_stats: %s is torn/stale: writer stuck mid-update\n", path.c_str());
+        } else {
+            std::fprintf(stderr, "logz_stats: %s has unsupported version %u\n", path.c_str(), page->version);
+        }
+        ::munmap(block, sizeof(StatsPageLayout));
+        return 1;
+    }
+    if (::kill(static_cast<pid_t>(page->pid), 0) != 0 && errno == ESRCH) {
+        std::fprintf(stderr, "logz_stats: warning: process %llu is gone, values are stale\n",
+                     static_cast<unsigned long long>(page->pid));
+    }
+
+    // Fields this tool does not know yet are skipped
+    for (size_t i = 0; i < count && i < static_cast<size_t>(StatsField::COUNT); ++i) {
+        const StatsFieldInfo& field = STATS_FIELDS[i];
+        bool seconds = std::strstr(field.name, "_seconds") != nullptr;
+        std::printf("# HELP %s %s\n# TYPE %s %s\n", field.name, field.help, field.name, field.type);
+        if (seconds) {
+            std::printf("%s{pid=\"%llu\"} %.9f\n", field.name,
+                        static_cast<unsigned long long>(page->pid), static_cast<double>(values[i]) / 1e9);
+        } else {
+            std::printf("%s{pid=\"%llu\"} %llu\n", field.name,
+                        static_cast<unsigned long long>(page->pid), static_cast<unsigned long long>(values[i]));
+        }
+    }
+    ::munmap(block, sizeof(StatsPageLayout));
+    return 0;
+}